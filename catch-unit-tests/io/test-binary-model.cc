@@ -0,0 +1,171 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "catch/include/catch.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+#include "io/binary_model.h"
+#include "learning/tree/ensemble.h"
+#include "random_models.h"
+
+namespace {
+
+/// Sets the probabilities of the children of some of the nodes.
+void set_probabilities(RTNode *node, std::mt19937 &gen) {
+  if (node->is_leaf())
+    return;
+  if (gen() % 2)
+    node->set_children_probability(gen() % 10, 1 + gen() % 10);
+  set_probabilities(node->left, gen);
+  set_probabilities(node->right, gen);
+}
+
+/// Returns true if the trees have the same probabilities of the children.
+bool same_probabilities(const RTNode *a, const RTNode *b) {
+  if (a->is_leaf() || b->is_leaf())
+    return a->is_leaf() && b->is_leaf();
+  return a->left->probability == b->left->probability
+      && a->right->probability == b->right->probability
+      && same_probabilities(a->left, b->left)
+      && same_probabilities(a->right, b->right);
+}
+
+}  // namespace
+
+TEST_CASE( "Testing binary model save and mapping", "[io][binary]" ) {
+
+  std::mt19937 gen(5);
+  const size_t num_trees = 60;
+  const size_t num_features = 30;
+  const std::string filename = "quickrank-test-model.bin";
+  const std::vector<std::pair<std::string, std::string>> info = {
+      {"type", "LAMBDAMART"}, {"trees", "60"}, {"shrinkage", "0.1"}};
+
+  Ensemble ensemble;
+  ensemble.set_capacity(num_trees);
+  for (size_t t = 0; t < num_trees; ++t) {
+    RTNode *tree = random_tree(1 + gen() % 30, num_features, gen);
+    set_probabilities(tree, gen);
+    ensemble.push(tree, 0.1 + (gen() % 10) / 10.0, 0);
+  }
+
+  std::vector<quickrank::Feature> documents(100 * num_features);
+  for (auto &x: documents)
+    x = (gen() % 21) / 10.0f;
+  std::vector<quickrank::Score> expected;
+  for (size_t i = 0; i < documents.size(); i += num_features)
+    expected.push_back(ensemble.score_instance(&documents[i]));
+
+  {
+    std::ofstream os(filename, std::ofstream::binary);
+    quickrank::io::BinaryModel::write_header(os, info);
+    ensemble.write_binary(os);
+  }
+  REQUIRE( quickrank::io::BinaryModel::is_binary_model(filename) );
+
+  auto binary_model = std::make_shared<quickrank::io::BinaryModel>(filename);
+  REQUIRE( binary_model->info() == info );
+
+  // the mapped trees give exactly the same scores
+  Ensemble mapped;
+  REQUIRE( mapped.map_binary(binary_model->data(), binary_model->data_size(),
+                             binary_model) );
+  REQUIRE( mapped.is_flat() );
+  REQUIRE( mapped.get_size() == num_trees );
+  REQUIRE( mapped.get_weights() == ensemble.get_weights() );
+  REQUIRE( mapped.num_features() == ensemble.num_features() );
+  REQUIRE( mapped.num_features() <= num_features );
+  std::vector<quickrank::Score> scores(expected.size(), 0.0);
+  mapped.add_scores(documents.data(), expected.size(), num_features, 1,
+                    scores.data());
+  REQUIRE( scores == expected );
+
+  // so do the trees rebuilt from the mapped ones, which keep the
+  // probabilities of the branches
+  for (size_t t = 0; t < num_trees; ++t)
+    REQUIRE( same_probabilities(mapped.getTree(t), ensemble.getTree(t)) );
+  for (size_t i = 0; i < documents.size(); i += num_features) {
+    double score = 0.0;
+    for (size_t t = 0; t < num_trees; ++t)
+      score += mapped.getTree(t)->score_instance(&documents[i], 1)
+          * mapped.getWeight(t);
+    REQUIRE( score == expected[i / num_features] );
+  }
+
+  // modifying the ensemble releases the mapping
+  binary_model.reset();
+  mapped.pop();
+  mapped.flatten();
+  ensemble.pop();
+  for (size_t i = 0; i < documents.size(); i += num_features)
+    REQUIRE( mapped.score_instance(&documents[i])
+                 == ensemble.score_instance(&documents[i]) );
+
+  // truncated data is rejected
+  binary_model = std::make_shared<quickrank::io::BinaryModel>(filename);
+  Ensemble truncated;
+  REQUIRE( !truncated.map_binary(binary_model->data(),
+                                 binary_model->data_size() - 8,
+                                 binary_model) );
+
+  std::remove(filename.c_str());
+}
+
+TEST_CASE( "Testing invalid binary models", "[io][binary]" ) {
+
+  using quickrank::io::BinaryModel;
+
+  const std::string filename = "quickrank-test-invalid-model.bin";
+
+  // invalid files are rejected without exiting
+  REQUIRE( !BinaryModel::open(filename) );
+  {
+    std::ofstream os(filename, std::ofstream::binary);
+    os.write(BinaryModel::MAGIC, sizeof(BinaryModel::MAGIC));
+  }
+  REQUIRE( BinaryModel::is_binary_model(filename) );
+  REQUIRE( !BinaryModel::open(filename) );
+
+  // so are info parameters truncated
+  std::string header;
+  {
+    std::ostringstream os;
+    BinaryModel::write_header(os, {{"type", "MART"}, {"trees", "10"}});
+    header = os.str();
+  }
+  {
+    std::ofstream os(filename, std::ofstream::binary);
+    os << header;
+  }
+  REQUIRE( BinaryModel::open(filename) );
+  {
+    std::ofstream os(filename, std::ofstream::binary);
+    os << header.substr(0, header.size() - 10);
+  }
+  REQUIRE( !BinaryModel::open(filename) );
+
+  std::remove(filename.c_str());
+}
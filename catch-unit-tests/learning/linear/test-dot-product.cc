@@ -0,0 +1,67 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "catch/include/catch.hpp"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "learning/linear/dot_product.h"
+
+using quickrank::learning::Layout;
+
+TEST_CASE( "Testing batched dot products", "[learning][linear][dot]" ) {
+
+  std::mt19937 gen(1);
+  const size_t num_features = 37;
+  const size_t num_documents = 101;
+
+  std::vector<double> weights(num_features);
+  for (auto &w: weights)
+    w = (gen() % 2001) / 1000.0 - 1.0;
+
+  std::vector<quickrank::Feature> rows(num_documents * num_features);
+  for (auto &x: rows)
+    x = (gen() % 2001) / 100.0f;
+  std::vector<quickrank::Feature> columns(rows.size());
+  for (size_t i = 0; i < num_documents; ++i)
+    for (size_t f = 0; f < num_features; ++f)
+      columns[f * num_documents + i] = rows[i * num_features + f];
+
+  std::vector<quickrank::Score> expected(num_documents, 0.0);
+  for (size_t i = 0; i < num_documents; ++i)
+    for (size_t f = 0; f < num_features; ++f)
+      expected[i] += weights[f] * rows[i * num_features + f];
+
+  // scores must match exactly the ones of the scalar dot product
+  std::vector<quickrank::Score> scores(num_documents);
+  quickrank::learning::linear::dot_product_batch(
+      weights, rows.data(), num_documents, num_features, Layout::ROW_MAJOR,
+      scores.data());
+  REQUIRE( scores == expected );
+
+  std::fill(scores.begin(), scores.end(), -1.0);
+  quickrank::learning::linear::dot_product_batch(
+      weights, columns.data(), num_documents, num_documents,
+      Layout::COLUMN_MAJOR, scores.data());
+  REQUIRE( scores == expected );
+}
@@ -0,0 +1,257 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "catch/include/catch.hpp"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "learning/tree/ensemble.h"
+#include "random_models.h"
+
+namespace {
+
+void random_probabilities(RTNode *node, std::mt19937 &gen) {
+  if (node->is_leaf())
+    return;
+  size_t lcount = gen() % 10;
+  node->set_children_probability(lcount, 9 - lcount);
+  random_probabilities(node->left, gen);
+  random_probabilities(node->right, gen);
+}
+
+}  // namespace
+
+TEST_CASE( "Testing flattened Ensemble scoring", "[learning][tree][ensemble]" ) {
+
+  std::mt19937 gen(1);
+  const size_t num_trees = 100;
+  const size_t num_features = 30;
+
+  Ensemble ensemble;
+  ensemble.set_capacity(num_trees);
+  for (size_t t = 0; t < num_trees; ++t)
+    ensemble.push(random_tree(1 + gen() % 40, num_features, gen),
+                  (gen() % 3) / 2.0, 0);
+  REQUIRE( !ensemble.is_flat() );
+
+  std::vector<quickrank::Feature> documents(200 * num_features);
+  for (auto &x: documents)
+    x = (gen() % 21) / 10.0f;
+
+  std::vector<quickrank::Score> expected;
+  std::vector<std::vector<quickrank::Score>> expected_partial;
+  for (size_t i = 0; i < documents.size(); i += num_features) {
+    expected.push_back(ensemble.score_instance(&documents[i]));
+    expected_partial.push_back(*ensemble.partial_scores_instance(&documents[i]));
+  }
+
+  // scores on the flattened trees must match exactly the tree nodes ones
+  ensemble.flatten();
+  REQUIRE( ensemble.is_flat() );
+  for (size_t i = 0; i < documents.size(); i += num_features) {
+    REQUIRE( ensemble.score_instance(&documents[i])
+                 == expected[i / num_features] );
+    REQUIRE( *ensemble.partial_scores_instance(&documents[i])
+                 == expected_partial[i / num_features] );
+  }
+
+  // removing zero-weighted trees keeps the flattened trees in sync
+  ensemble.filter_out_zero_weighted_trees();
+  REQUIRE( ensemble.get_size() < num_trees );
+  REQUIRE( ensemble.is_flat() );
+  for (size_t i = 0; i < documents.size(); i += num_features)
+    REQUIRE( ensemble.score_instance(&documents[i])
+                 == expected[i / num_features] );
+
+  // adding a tree discards the flattened trees
+  ensemble.push(new RTNode(1.0), 1.0, 0);
+  REQUIRE( !ensemble.is_flat() );
+}
+
+TEST_CASE( "Testing flattened Ensemble scoring with branch probabilities",
+           "[learning][tree][ensemble]" ) {
+
+  std::mt19937 gen(3);
+  const size_t num_trees = 50;
+  const size_t num_features = 30;
+
+  Ensemble ensemble;
+  ensemble.set_capacity(num_trees);
+  for (size_t t = 0; t < num_trees; ++t) {
+    RTNode *tree = random_tree(1 + gen() % 40, num_features, gen);
+    random_probabilities(tree, gen);
+    ensemble.push(tree, 0.1 + (gen() % 10) / 10.0, 0);
+  }
+
+  std::vector<quickrank::Feature> documents(200 * num_features);
+  for (auto &x: documents)
+    x = (gen() % 21) / 10.0f;
+
+  std::vector<quickrank::Score> expected;
+  for (size_t i = 0; i < documents.size(); i += num_features)
+    expected.push_back(ensemble.score_instance(&documents[i]));
+
+  // placing the likely children first does not change the scores
+  ensemble.flatten();
+  REQUIRE( ensemble.is_flat() );
+  for (size_t i = 0; i < documents.size(); i += num_features)
+    REQUIRE( ensemble.score_instance(&documents[i])
+                 == expected[i / num_features] );
+}
+
+TEST_CASE( "Testing batched Ensemble scoring", "[learning][tree][ensemble]" ) {
+
+  std::mt19937 gen(2);
+  const size_t num_trees = 50;
+  const size_t num_features = 30;
+  const size_t num_documents = 101;
+
+  Ensemble ensemble;
+  ensemble.set_capacity(num_trees);
+  for (size_t t = 0; t < num_trees; ++t)
+    ensemble.push(random_tree(1 + gen() % 40, num_features, gen),
+                  0.1 + (gen() % 10) / 10.0, 0);
+
+  std::vector<quickrank::Feature> rows(num_documents * num_features);
+  for (auto &x: rows)
+    x = (gen() % 21) / 10.0f;
+  std::vector<quickrank::Feature> columns(rows.size());
+  for (size_t i = 0; i < num_documents; ++i)
+    for (size_t f = 0; f < num_features; ++f)
+      columns[f * num_documents + i] = rows[i * num_features + f];
+
+  std::vector<quickrank::Score> expected(num_documents);
+  for (size_t i = 0; i < num_documents; ++i)
+    expected[i] = ensemble.score_instance(&rows[i * num_features]);
+
+  // scores must match exactly the ones of single documents, in both layouts,
+  // both on the tree nodes and on the flattened trees
+  for (int flat = 0; flat < 2; ++flat) {
+    if (flat)
+      ensemble.flatten();
+    std::vector<quickrank::Score> scores(num_documents, 0.0);
+    ensemble.add_scores(rows.data(), num_documents, num_features, 1,
+                        scores.data());
+    REQUIRE( scores == expected );
+
+    std::fill(scores.begin(), scores.end(), 0.0);
+    ensemble.add_scores(columns.data(), num_documents, 1, num_documents,
+                        scores.data());
+    REQUIRE( scores == expected );
+
+    // adding the trees in two ranges gives the same scores
+    std::fill(scores.begin(), scores.end(), 0.0);
+    ensemble.add_scores(rows.data(), num_documents, num_features, 1,
+                        scores.data(), 0, num_trees / 2);
+    ensemble.add_scores(rows.data(), num_documents, num_features, 1,
+                        scores.data(), num_trees / 2);
+    REQUIRE( scores == expected );
+  }
+}
+
+TEST_CASE( "Testing batched Ensemble scoring on a few features",
+           "[learning][tree][ensemble]" ) {
+
+  std::mt19937 gen(4);
+  const size_t num_trees = 200;
+  const size_t num_features = 700;
+  const size_t num_used = 60;
+  const size_t num_documents = 37;
+
+  // the trees use only every num_features / num_used feature
+  Ensemble ensemble;
+  ensemble.set_capacity(num_trees);
+  for (size_t t = 0; t < num_trees; ++t) {
+    RTNode *tree = random_tree(1 + gen() % 20, num_used, gen);
+    std::vector<RTNode *> nodes(1, tree);
+    while (!nodes.empty()) {
+      RTNode *node = nodes.back();
+      nodes.pop_back();
+      if (node->is_leaf())
+        continue;
+      size_t feature = node->get_feature_idx() * (num_features / num_used);
+      node->set_feature(feature, feature + 1);
+      nodes.push_back(node->left);
+      nodes.push_back(node->right);
+    }
+    ensemble.push(tree, 0.1 + (gen() % 10) / 10.0, 0);
+  }
+
+  std::vector<quickrank::Feature> rows(num_documents * num_features);
+  for (auto &x: rows)
+    x = (gen() % 21) / 10.0f;
+
+  std::vector<quickrank::Score> expected(num_documents);
+  for (size_t i = 0; i < num_documents; ++i)
+    expected[i] = ensemble.score_instance(&rows[i * num_features]);
+
+  // gathering the used features does not change the scores, nor does
+  // scoring a single tree on the whole documents
+  ensemble.flatten();
+  std::vector<quickrank::Score> scores(num_documents, 0.0);
+  ensemble.add_scores(rows.data(), num_documents, num_features, 1,
+                      scores.data(), 0, num_trees - 1);
+  ensemble.add_scores(rows.data(), num_documents, num_features, 1,
+                      scores.data(), num_trees - 1);
+  REQUIRE( scores == expected );
+}
+
+TEST_CASE( "Testing Ensemble tree reordering", "[learning][tree][ensemble]" ) {
+
+  std::mt19937 gen(1);
+  const size_t num_trees = 50;
+  const size_t num_features = 30;
+
+  Ensemble ensemble;
+  ensemble.set_capacity(num_trees);
+  for (size_t t = 0; t < num_trees; ++t)
+    ensemble.push(random_tree(1 + gen() % 40, num_features, gen),
+                  0.1 + (gen() % 10) / 10.0, 0);
+  ensemble.flatten();
+
+  std::vector<quickrank::Feature> document(num_features);
+  for (auto &x: document)
+    x = (gen() % 21) / 10.0f;
+  auto partial = ensemble.partial_scores_instance(document.data());
+
+  std::vector<size_t> order(num_trees);
+  for (size_t t = 0; t < num_trees; ++t)
+    order[t] = t;
+  std::shuffle(order.begin(), order.end(), gen);
+  REQUIRE( ensemble.reorder_trees(order) );
+  REQUIRE( ensemble.is_flat() );
+
+  // the i-th tree is the order[i]-th one, on the tree nodes as well
+  auto reordered = ensemble.partial_scores_instance(document.data());
+  for (size_t t = 0; t < num_trees; ++t) {
+    REQUIRE( (*reordered)[t] == (*partial)[order[t]] );
+    REQUIRE( ensemble.getTree(t)->score_instance(document.data(), 1)
+                 * ensemble.getWeight(t) == (*partial)[order[t]] );
+  }
+
+  // orders must be permutations of the trees
+  order.pop_back();
+  REQUIRE_FALSE( ensemble.reorder_trees(order) );
+  order.push_back(order.front());
+  REQUIRE_FALSE( ensemble.reorder_trees(order) );
+}
@@ -0,0 +1,70 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "catch/include/catch.hpp"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "metric/ir/evaluator.h"
+#include "metric/ir/dcg.h"
+#include "metric/ir/ndcg.h"
+#include "metric/ir/tndcg.h"
+#include "metric/ir/map.h"
+#include "metric/ir/rmse.h"
+#include "data/dataset.h"
+
+TEST_CASE( "Testing single-pass multi-metric evaluation", "[metric][evaluator]" ) {
+
+  std::mt19937 gen(1);
+  auto dataset = std::make_shared<quickrank::data::Dataset>(50 * 30, 1);
+  for (size_t q = 0; q < 50; q++)
+    for (size_t i = 0; i < 30; i++)
+      dataset->addInstance(q, gen() % 5, {0.0f});
+
+  // distinct scores, so that every metric ranks results the same way
+  std::vector<quickrank::Score> scores(dataset->num_instances());
+  for (size_t i = 0; i < scores.size(); i++)
+    scores[i] = i;
+  std::shuffle(scores.begin(), scores.end(), gen);
+
+  std::vector<std::shared_ptr<quickrank::metric::ir::Metric>> metrics = {
+      std::make_shared<quickrank::metric::ir::Ndcg>(10),
+      std::make_shared<quickrank::metric::ir::Dcg>(5),
+      std::make_shared<quickrank::metric::ir::Tndcg>(20),
+      std::make_shared<quickrank::metric::ir::Map>(),
+      std::make_shared<quickrank::metric::ir::Rmse>() };
+
+  quickrank::metric::ir::Evaluator evaluator(metrics);
+  REQUIRE( evaluator.num_metrics() == metrics.size() );
+
+  std::vector<quickrank::MetricScore> metric_scores =
+      evaluator.evaluate_dataset(dataset, &scores[0]);
+  REQUIRE( metric_scores.size() == metrics.size() );
+  for (size_t m = 0; m < metrics.size(); m++)
+    REQUIRE( metric_scores[m] ==
+        Approx(metrics[m]->evaluate_dataset(dataset, &scores[0])) );
+
+  // precomputed per-query data must not change the results
+  evaluator.prepare(dataset);
+  REQUIRE( evaluator.evaluate_dataset(dataset, &scores[0]) == metric_scores );
+}
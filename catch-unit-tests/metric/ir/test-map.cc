@@ -0,0 +1,84 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "catch/include/catch.hpp"
+
+#include "metric/ir/map.h"
+#include "data/dataset.h"
+#include "data/rankedresults.h"
+
+TEST_CASE( "Testing MAP", "[metric][map]" ) {
+
+  quickrank::Label labels[] = { 0, 1, 0, 0, 1 };
+  quickrank::Score scores[] = { 1, 5, 4, 3, 2 };
+  auto results = std::shared_ptr<quickrank::data::QueryResults>(
+      new quickrank::data::QueryResults(5, &labels[0], NULL) );
+
+  // ranked labels are: 1, 0, 0, 1, 0
+  quickrank::metric::ir::Map map_metric(0);
+
+  // MAP computation without cutoff
+  REQUIRE( Approx( map_metric.evaluate_result_list(results.get(), scores) ) ==
+      (1.0 + 2.0 / 4.0) / 2.0 );
+
+  // MAP@k computation with K < num results
+  map_metric.set_cutoff(3);
+  REQUIRE( Approx( map_metric.evaluate_result_list(results.get(), scores) ) ==
+      1.0 );
+
+  map_metric.set_cutoff(4);
+  REQUIRE( Approx( map_metric.evaluate_result_list(results.get(), scores) ) ==
+      (1.0 + 2.0 / 4.0) / 2.0 );
+
+  // MAP@k computation with no relevant documents in the top K
+  scores[1] = 0;
+  map_metric.set_cutoff(2);
+  REQUIRE( map_metric.evaluate_result_list(results.get(), scores) == 0.0 );
+
+  // Jacobian, checked against swapping the scores of each pair of documents
+  quickrank::Label long_labels[] = { 1, 0, 0, 1, 1, 0, 1, 0, 0, 1 };
+  quickrank::Score long_scores[] = { 9, 8, 7, 6, 5, 4, 3, 2, 1, 0 };
+  auto long_results = std::shared_ptr<quickrank::data::QueryResults>(
+      new quickrank::data::QueryResults(10, &long_labels[0], NULL) );
+  map_metric.set_cutoff(0);
+
+  auto ranked_list = std::shared_ptr<quickrank::data::RankedResults>(
+      new quickrank::data::RankedResults(long_results, long_scores));
+  auto jacobian = map_metric.jacobian(ranked_list);
+  auto swap_deltas = map_metric.swap_deltas(ranked_list);
+  double deltas[10];
+
+  double ap = map_metric.evaluate_result_list(long_results.get(),
+                                              long_scores);
+  for (size_t i = 0; i < 10; ++i) {
+    swap_deltas->row(i, deltas);
+    for (size_t j = i + 1; j < 10; ++j) {
+      std::swap(long_scores[i], long_scores[j]);
+      double true_delta_ap = map_metric.evaluate_result_list(
+          long_results.get(), long_scores) - ap;
+      std::swap(long_scores[i], long_scores[j]);
+
+      REQUIRE( Approx(jacobian->at(i, j)) == true_delta_ap );
+      REQUIRE( Approx(deltas[j]) == true_delta_ap );
+    }
+  }
+
+}
@@ -0,0 +1,115 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "catch/include/catch.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "metric/ir/ndcg.h"
+#include "metric/ir/map.h"
+#include "metric/ir/rmse.h"
+#include "data/dataset.h"
+
+namespace {
+
+std::shared_ptr<quickrank::data::Dataset> random_dataset(
+    size_t num_queries, size_t results_per_query, std::mt19937 &gen) {
+  auto dataset = std::make_shared<quickrank::data::Dataset>(
+      num_queries * results_per_query, 1);
+  for (size_t q = 0; q < num_queries; q++)
+    for (size_t i = 0; i < results_per_query; i++)
+      dataset->addInstance(q, gen() % 5, {0.0f});
+  return dataset;
+}
+
+}  // namespace
+
+TEST_CASE( "Testing batched metric evaluation", "[metric][batch]" ) {
+
+  std::mt19937 gen(1);
+  auto dataset = random_dataset(50, 30, gen);
+  const size_t num_candidates = 7;
+  std::vector<quickrank::Score> scores(dataset->num_instances()
+                                           * num_candidates);
+  for (auto &s: scores)
+    s = gen() % 100;
+
+  std::shared_ptr<quickrank::metric::ir::Metric> metrics[] = {
+      std::make_shared<quickrank::metric::ir::Ndcg>(10),
+      std::make_shared<quickrank::metric::ir::Map>(),
+      std::make_shared<quickrank::metric::ir::Rmse>() };
+
+  for (auto metric: metrics) {
+    std::vector<quickrank::MetricScore> metric_scores(num_candidates);
+    metric->evaluate_dataset_batch(dataset, &scores[0], num_candidates,
+                                   &metric_scores[0]);
+    // each candidate must score exactly as a single evaluation
+    for (size_t p = 0; p < num_candidates; p++)
+      REQUIRE( metric_scores[p] == metric->evaluate_dataset(
+          dataset, &scores[p * dataset->num_instances()]) );
+  }
+}
+
+TEST_CASE( "Benchmark batched metric evaluation", "[.][metric][batch][benchmark]" ) {
+
+  std::mt19937 gen(1);
+  auto dataset = random_dataset(2000, 100, gen);
+  const size_t num_candidates = 32;
+  std::vector<quickrank::Score> scores(dataset->num_instances()
+                                           * num_candidates);
+  for (auto &s: scores)
+    s = gen() % 1000;
+
+  quickrank::metric::ir::Ndcg ndcg_metric(10);
+  ndcg_metric.prepare(dataset);
+  std::vector<quickrank::MetricScore> single(num_candidates);
+  std::vector<quickrank::MetricScore> batch(num_candidates);
+
+  auto start = std::chrono::high_resolution_clock::now();
+  #pragma omp parallel for
+  for (size_t p = 0; p < num_candidates; p++)
+    single[p] = ndcg_metric.evaluate_dataset(
+        dataset, &scores[p * dataset->num_instances()]);
+  auto end = std::chrono::high_resolution_clock::now();
+  double single_time =
+      std::chrono::duration_cast<std::chrono::duration<double>>(
+          end - start).count();
+
+  start = std::chrono::high_resolution_clock::now();
+  ndcg_metric.evaluate_dataset_batch(dataset, &scores[0], num_candidates,
+                                     &batch[0]);
+  end = std::chrono::high_resolution_clock::now();
+  double batch_time =
+      std::chrono::duration_cast<std::chrono::duration<double>>(
+          end - start).count();
+
+  std::cout << "# " << ndcg_metric << " on " << dataset->num_queries()
+      << " queries x " << num_candidates << " candidates" << std::endl
+      << "# one dataset pass per candidate: "
+      << num_candidates / single_time << " candidates/s" << std::endl
+      << "# single batched pass: "
+      << num_candidates / batch_time << " candidates/s" << std::endl;
+
+  REQUIRE( single == batch );
+}
@@ -105,3 +105,33 @@ TEST_CASE( "Testing NDCG", "[metric][ndcg]" ) {
   REQUIRE( Approx(delta_ndcg) == ( pow(2, labels[2])  - pow(2, labels[0]) )/idcg );
 
 }
+
+TEST_CASE( "Testing NDCG on a prepared dataset", "[metric][ndcg]" ) {
+
+  quickrank::Label labels[] = { 0, 2, 1, 3, 0,   1, 0, 0 };
+  quickrank::Score scores[] = { 5, 4, 3, 2, 1,   1, 2, 3 };
+  auto dataset = std::make_shared<quickrank::data::Dataset>(8, 1);
+  for (size_t i = 0; i < 8; i++)
+    dataset->addInstance(i < 5 ? 1 : 2, labels[i], {0.0f});
+
+  quickrank::metric::ir::Ndcg ndcg_metric(3);
+  quickrank::MetricScore ndcg = ndcg_metric.evaluate_dataset(dataset, scores);
+  auto results = dataset->getQueryResults(0);
+  quickrank::MetricScore ndcg_first =
+      ndcg_metric.evaluate_result_list(results.get(), scores);
+
+  // precomputed gains and ideal DCG give the same results
+  ndcg_metric.prepare(dataset);
+  REQUIRE( ndcg_metric.evaluate_dataset(dataset, scores) == ndcg );
+  REQUIRE( ndcg_metric.evaluate_result_list(results.get(), scores) ==
+      ndcg_first );
+
+  // precomputed data is discarded when the cutoff changes
+  ndcg_metric.set_cutoff(5);
+  REQUIRE( Approx( ndcg_metric.evaluate_result_list(results.get(), scores) ) ==
+      ( (pow(2, labels[1]) - 1) / log2(3) + (pow(2, labels[2]) - 1) / 2
+          + (pow(2, labels[3]) - 1) / log2(5) ) /
+      ( (pow(2, labels[3]) - 1) + (pow(2, labels[1]) - 1) / log2(3)
+          + (pow(2, labels[2]) - 1) / 2 ) );
+
+}
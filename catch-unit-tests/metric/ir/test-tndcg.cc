@@ -104,4 +104,30 @@ TEST_CASE( "Testing TNDCG", "[metric][tndcg]" ) {
   //  std::cout << ((pow(2, labels[2]) - 1) - (pow(2, labels[0]) - 1))/idcg << std::endl;
   REQUIRE( Approx(delta_tndcg) == ( pow(2, labels[2])  - pow(2, labels[0]) )/idcg );
 
+  // Jacobian and swap deltas, with ties and cutoff, checked against swapping
+  // the scores of each pair of documents (ties do not cross the cutoff, as
+  // the deltas of documents tied across it are approximated)
+  scores[1] = 5;
+  scores[3] = 1;
+  ranked_list = std::shared_ptr<quickrank::data::RankedResults>(new quickrank::data::RankedResults(results, scores));
+  auto jacobian = tndcg_metric.jacobian(ranked_list);
+  auto swap_deltas = tndcg_metric.swap_deltas(ranked_list);
+  double deltas[5];
+
+  double tndcg = tndcg_metric.evaluate_result_list(results.get(), scores);
+  for (size_t i = 0; i < 5; ++i) {
+    swap_deltas->row(i, deltas);
+    for (size_t j = i + 1; j < 5; ++j) {
+      const size_t pos_i = ranked_list->pos_of_rank(i);
+      const size_t pos_j = ranked_list->pos_of_rank(j);
+      std::swap(scores[pos_i], scores[pos_j]);
+      true_delta_tndcg = tndcg_metric.evaluate_result_list(results.get(),
+                                                           scores) - tndcg;
+      std::swap(scores[pos_i], scores[pos_j]);
+
+      REQUIRE( Approx(jacobian->at(i, j)) == true_delta_tndcg );
+      REQUIRE( Approx(deltas[j]) == true_delta_tndcg );
+    }
+  }
+
 }
@@ -0,0 +1,86 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "data/dataset.h"
+#include "learning/tree/ensemble.h"
+
+// Random trees, ensembles and datasets shared by the unit tests.
+
+/// Returns a tree with the given number of leaves, splitting on the first
+/// \a num_features features.
+inline RTNode *random_tree(size_t num_leaves, size_t num_features,
+                           std::mt19937 &gen) {
+  std::uniform_real_distribution<double> value(-1.0, 1.0);
+  if (num_leaves == 1)
+    return new RTNode(value(gen));
+  size_t left_leaves = 1 + gen() % (num_leaves - 1);
+  RTNode *left = random_tree(left_leaves, num_features, gen);
+  RTNode *right = random_tree(num_leaves - left_leaves, num_features, gen);
+  size_t feature = gen() % num_features;
+  // few distinct thresholds, so that nodes and documents share some of them
+  float threshold = (gen() % 20) / 10.0f;
+  return new RTNode(threshold, feature, feature + 1, left, right);
+}
+
+/// Returns an ensemble of trees with at most \a max_leaves leaves each, the
+/// t-th one weighted by \a weight(t). There is room for one more tree.
+inline Ensemble random_ensemble(size_t num_trees, size_t num_features,
+                                size_t max_leaves,
+                                const std::function<double(size_t)> &weight,
+                                std::mt19937 &gen) {
+  Ensemble ensemble;
+  ensemble.set_capacity(num_trees + 1);
+  for (size_t t = 0; t < num_trees; ++t) {
+    RTNode *tree = random_tree(1 + gen() % max_leaves, num_features, gen);
+    ensemble.push(tree, weight(t), 0);
+  }
+  return ensemble;
+}
+
+/// Returns a dataset whose labels are the quantiles of the scores of the
+/// ensemble, with some noise.
+inline std::shared_ptr<quickrank::data::Dataset> random_dataset(
+    const Ensemble &ensemble, size_t num_queries, size_t num_documents,
+    size_t num_features, std::mt19937 &gen) {
+  auto dataset = std::make_shared<quickrank::data::Dataset>(
+      num_queries * num_documents, num_features);
+  std::vector<quickrank::Feature> features(num_features);
+  for (size_t q = 0; q < num_queries; ++q) {
+    for (size_t i = 0; i < num_documents; ++i) {
+      for (auto &x: features)
+        x = (gen() % 21) / 10.0f;
+      double score = ensemble.score_instance(features.data())
+          + (gen() % 100) / 100.0;
+      dataset->addInstance(q, std::max(std::min(std::floor(score), 4.0), 0.0),
+                           features);
+    }
+  }
+  return dataset;
+}
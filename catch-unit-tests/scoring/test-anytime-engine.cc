@@ -0,0 +1,150 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "catch/include/catch.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#else
+#include "utils/omp-stubs.h"
+#endif
+
+#include "data/dataset.h"
+#include "learning/tree/ensemble.h"
+#include "scoring/anytime_engine.h"
+#include "random_models.h"
+
+namespace {
+
+/// The weights increase, so that the last trees contribute most of the
+/// score.
+Ensemble increasing_ensemble(size_t num_trees, size_t num_features,
+                             std::mt19937 &gen) {
+  return random_ensemble(
+      num_trees, num_features, 16,
+      [num_trees](size_t t) { return 1.0 / (1.0 + (num_trees - t) / 10.0); },
+      gen);
+}
+
+}  // namespace
+
+TEST_CASE( "Testing AnytimeEngine", "[scoring][anytime]" ) {
+
+  using quickrank::scoring::AnytimeEngine;
+
+  std::mt19937 gen(1);
+  const size_t num_trees = 100;
+  const size_t num_features = 10;
+  const size_t num_documents = 203;
+
+  Ensemble ensemble = increasing_ensemble(num_trees, num_features, gen);
+  auto dataset = random_dataset(ensemble, 1, num_documents, num_features, gen);
+  const quickrank::Feature *documents = dataset->at(0, 0);
+
+  std::vector<quickrank::Score> expected(num_documents);
+  for (size_t i = 0; i < num_documents; ++i)
+    expected[i] = ensemble.score_instance(documents + i * num_features);
+
+  // no budget scores the whole ensemble
+  AnytimeEngine full(ensemble);
+  std::vector<quickrank::Score> scores(num_documents);
+  full.score_documents(documents, num_documents, num_features, scores.data());
+  REQUIRE( scores == expected );
+  REQUIRE( full.trees_evaluated() == num_documents * num_trees );
+  REQUIRE( full.queries_interrupted() == 0 );
+
+  // budgets of trees not multiple of the blocks
+  AnytimeEngine partial(ensemble, 37, 0.0, 10);
+  partial.score_documents(documents, num_documents, num_features,
+                          scores.data());
+  std::vector<quickrank::Score> first_trees(num_documents, 0.0);
+  ensemble.add_scores(documents, num_documents, num_features, 1,
+                      first_trees.data(), 0, 37);
+  for (size_t i = 0; i < num_documents; ++i)
+    REQUIRE( scores[i] == Approx(first_trees[i]) );
+  REQUIRE( partial.trees_evaluated() == num_documents * 37 );
+
+  // an exhausted budget of time still scores the first block
+  AnytimeEngine hurried(ensemble, SIZE_MAX, 1e-12, 10);
+  hurried.score_documents(documents, num_documents, num_features,
+                          scores.data());
+  REQUIRE( hurried.queries_interrupted() == 1 );
+  REQUIRE( hurried.trees_evaluated() == num_documents * 10 );
+  hurried.reset_statistics();
+  REQUIRE( hurried.trees_evaluated() == 0 );
+}
+
+TEST_CASE( "Testing AnytimeEngine tree orders", "[scoring][anytime]" ) {
+
+  using quickrank::scoring::AnytimeEngine;
+
+  std::mt19937 gen(2);
+  const size_t num_trees = 200;
+  const size_t num_features = 10;
+  const size_t k = 10;
+
+  Ensemble ensemble = increasing_ensemble(num_trees, num_features, gen);
+  auto validation = random_dataset(ensemble, 50, 100, num_features, gen);
+  auto test = random_dataset(ensemble, 50, 100, num_features, gen);
+  auto many_queries = random_dataset(ensemble, 600, 5, num_features, gen);
+  ensemble.push(new RTNode(5.0), 1.0, 0);
+
+  // variances are summed in query order, whatever the number of threads
+  const int max_threads = omp_get_max_threads();
+  omp_set_num_threads(1);
+  auto sequential = AnytimeEngine::order_by_variance(ensemble, many_queries);
+  auto sequential_quality = AnytimeEngine::quality_curve(
+      ensemble, {num_trees / 10}, many_queries, k);
+  omp_set_num_threads(4);
+  REQUIRE( AnytimeEngine::order_by_variance(ensemble, many_queries)
+               == sequential );
+  REQUIRE( AnytimeEngine::quality_curve(ensemble, {num_trees / 10},
+                                        many_queries, k)
+               == sequential_quality );
+  omp_set_num_threads(max_threads);
+
+  // a single leaf adds the same score to every document
+  auto by_weight = AnytimeEngine::order_by_weight(ensemble);
+  auto by_variance = AnytimeEngine::order_by_variance(ensemble, validation);
+  REQUIRE( by_weight.back() == num_trees );
+  REQUIRE( by_variance.back() == num_trees );
+  REQUIRE( ensemble.reorder_trees(by_variance) );
+
+  // the most important trees are scored first
+  std::vector<size_t> budgets = {num_trees / 10, num_trees / 2,
+                                 num_trees + 1};
+  auto quality = AnytimeEngine::quality_curve(ensemble, budgets, test, k);
+  REQUIRE( quality.size() == budgets.size() );
+
+  std::vector<size_t> reverse(num_trees + 1);
+  for (size_t t = 0; t <= num_trees; ++t)
+    reverse[t] = num_trees - t;
+  REQUIRE( ensemble.reorder_trees(reverse) );
+  auto reverse_quality = AnytimeEngine::quality_curve(ensemble, budgets, test,
+                                                      k);
+  REQUIRE( quality[0] > reverse_quality[0] );
+  REQUIRE( quality.back() == Approx(reverse_quality.back()) );
+}
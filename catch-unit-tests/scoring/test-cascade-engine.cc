@@ -0,0 +1,149 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "catch/include/catch.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "data/dataset.h"
+#include "learning/tree/ensemble.h"
+#include "metric/ir/ndcg.h"
+#include "scoring/cascade_engine.h"
+#include "random_models.h"
+
+namespace {
+
+/// The weights decrease as in boosted ensembles, so that the first trees
+/// contribute most of the score.
+Ensemble decreasing_ensemble(size_t num_trees, size_t num_features,
+                             std::mt19937 &gen) {
+  return random_ensemble(num_trees, num_features, 16,
+                         [](size_t t) { return 1.0 / (1.0 + t / 10.0); },
+                         gen);
+}
+
+double mean_ndcg(std::shared_ptr<quickrank::data::Dataset> dataset,
+                 const std::vector<quickrank::Score> &scores, size_t k) {
+  quickrank::metric::ir::Ndcg ndcg(k);
+  double sum = 0.0;
+  for (size_t q = 0; q < dataset->num_queries(); ++q) {
+    auto results = dataset->getQueryResults(q);
+    sum += ndcg.evaluate_result_list(results.get(),
+                                     &scores[dataset->offset(q)]);
+  }
+  return sum / dataset->num_queries();
+}
+
+}  // namespace
+
+TEST_CASE( "Testing CascadeEngine", "[scoring][cascade]" ) {
+
+  using quickrank::scoring::CascadeEngine;
+
+  std::mt19937 gen(1);
+  const size_t num_trees = 100;
+  const size_t num_features = 10;
+  const size_t num_documents = 203;
+  const size_t k = 10;
+
+  Ensemble ensemble = decreasing_ensemble(num_trees, num_features, gen);
+  auto dataset = random_dataset(ensemble, 1, num_documents, num_features, gen);
+  const quickrank::Feature *documents = dataset->at(0, 0);
+
+  std::vector<quickrank::Score> expected(num_documents);
+  for (size_t i = 0; i < num_documents; ++i)
+    expected[i] = ensemble.score_instance(documents + i * num_features);
+
+  auto sentinels = CascadeEngine::even_sentinels(num_trees, 4);
+  REQUIRE( sentinels == std::vector<size_t>({25, 50, 75}) );
+  REQUIRE( CascadeEngine::even_sentinels(2, 4) == std::vector<size_t>({1}) );
+
+  // infinite margins score the whole ensemble
+  const double inf = std::numeric_limits<double>::infinity();
+  CascadeEngine full(ensemble, sentinels, k, {inf, inf, inf});
+  std::vector<quickrank::Score> scores(num_documents);
+  full.score_documents(documents, num_documents, num_features, scores.data());
+  REQUIRE( scores == expected );
+  REQUIRE( full.trees_evaluated() == num_documents * num_trees );
+  REQUIRE( full.score_document(documents) == expected[0] );
+
+  // zero margins keep the documents in the top k of each sentinel
+  CascadeEngine strict(ensemble, sentinels, k, {0.0, 0.0, 0.0});
+  strict.score_documents(documents, num_documents, num_features,
+                         scores.data());
+  REQUIRE( strict.documents_scored() == num_documents );
+  REQUIRE( strict.trees_evaluated()
+               == num_documents * 25 + 3 * k * 25 );
+  size_t survivors = 0;
+  for (size_t i = 0; i < num_documents; ++i) {
+    if (!std::isinf(scores[i])) {
+      REQUIRE( scores[i] == expected[i] );
+      ++survivors;
+    }
+  }
+  REQUIRE( survivors == k );
+
+  // few documents do not exit
+  strict.reset_statistics();
+  strict.score_documents(documents, k, num_features, scores.data());
+  REQUIRE( std::equal(scores.begin(), scores.begin() + k, expected.begin()) );
+  REQUIRE( strict.trees_evaluated() == k * num_trees );
+}
+
+TEST_CASE( "Testing CascadeEngine margins", "[scoring][cascade]" ) {
+
+  using quickrank::scoring::CascadeEngine;
+
+  std::mt19937 gen(2);
+  const size_t num_trees = 200;
+  const size_t num_features = 10;
+  const size_t k = 10;
+
+  Ensemble ensemble = decreasing_ensemble(num_trees, num_features, gen);
+  auto validation = random_dataset(ensemble, 50, 100, num_features, gen);
+  auto sentinels = CascadeEngine::even_sentinels(num_trees, 8);
+
+  std::vector<quickrank::Score> expected(validation->num_instances());
+  for (size_t i = 0; i < expected.size(); ++i)
+    expected[i] = ensemble.score_instance(validation->at(i, 0));
+  const double full_ndcg = mean_ndcg(validation, expected, k);
+
+  for (double max_loss: {0.0, 0.01, 0.05}) {
+    auto margins = CascadeEngine::learn_margins(ensemble, sentinels, k,
+                                                validation, max_loss);
+    REQUIRE( margins.size() == sentinels.size() );
+
+    CascadeEngine cascade(ensemble, sentinels, k, margins);
+    std::vector<quickrank::Score> scores(validation->num_instances());
+    cascade.score_dataset(validation, scores.data());
+    REQUIRE( mean_ndcg(validation, scores, k) >= full_ndcg - max_loss - 1e-9 );
+    REQUIRE( cascade.documents_scored() == validation->num_instances() );
+
+    // a loss of a few points of NDCG allows to skip many trees
+    if (max_loss >= 0.05)
+      REQUIRE( cascade.trees_evaluated()
+                   < validation->num_instances() * num_trees / 2 );
+  }
+}
@@ -0,0 +1,154 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "catch/include/catch.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <unistd.h>
+
+#include "data/dataset.h"
+#include "learning/forests/mart.h"
+#include "learning/forests/obliviousmart.h"
+#include "metric/ir/ndcg.h"
+#include "scoring/compiled_scorer.h"
+#include "random_models.h"
+
+namespace {
+
+/// Returns the names of the files in the given directory.
+std::vector<std::string> list_files(const std::string &dir) {
+  std::vector<std::string> files;
+  if (DIR *d = opendir(dir.c_str())) {
+    while (struct dirent *entry = readdir(d)) {
+      std::string name = entry->d_name;
+      if (name != "." && name != "..")
+        files.push_back(name);
+    }
+    closedir(d);
+  }
+  return files;
+}
+
+/// Returns true if the compiler used by the compiled scorers is available.
+bool has_compiler() {
+  const char *cxx = getenv("CXX");
+  const std::string compiler = cxx && *cxx ? cxx : "c++";
+  return std::system((compiler + " --version > /dev/null 2>&1").c_str()) == 0;
+}
+
+/// Returns a dataset labelled by a random ensemble.
+std::shared_ptr<quickrank::data::Dataset> labelled_dataset(
+    size_t num_features, std::mt19937 &gen) {
+  return random_dataset(
+      random_ensemble(20, num_features, 8, [](size_t) { return 1.0; }, gen),
+      20, 50, num_features, gen);
+}
+
+}  // namespace
+
+TEST_CASE( "Testing CompiledScorer", "[scoring][compiled]" ) {
+
+  if (!has_compiler()) {
+    WARN( "No compiler available, skipping the compiled scorers" );
+    return;
+  }
+
+  std::mt19937 gen(3);
+  const size_t num_features = 10;
+
+  auto dataset = labelled_dataset(num_features, gen);
+  // a shrinkage not representable by a float, nor by few decimal digits
+  quickrank::learning::forests::Mart mart(30, 0.0125, 0, 8, 1, 0);
+  mart.learn(dataset, nullptr,
+             std::make_shared<quickrank::metric::ir::Ndcg>(10), 0, "");
+  REQUIRE( mart.ensemble().get_size() == 30 );
+
+  const std::string dir = "quickrank-test-plugins";
+  setenv("QUICKRANK_PLUGINS_DIR", dir.c_str(), 1);
+
+  auto scorer = quickrank::scoring::CompiledScorer::create(mart, "CONDOP");
+  REQUIRE( scorer );
+  REQUIRE( scorer->name() == "COMPILED_CONDOP" );
+
+  // scores must match exactly the ones of the model
+  for (size_t i = 0; i < dataset->num_instances(); ++i) {
+    const quickrank::Feature *document = dataset->at(i, 0);
+    REQUIRE( scorer->score_document(document)
+                 == mart.ensemble().score_instance(document) );
+  }
+
+  // the temporary files are removed, and the cached shared object is loaded
+  // by the next scorer of the same model
+  const std::string plugin_path = scorer->plugin_path();
+  REQUIRE( list_files(dir).size() == 1 );
+  auto cached = quickrank::scoring::CompiledScorer::create(mart, "CONDOP");
+  REQUIRE( cached );
+  REQUIRE( cached->plugin_path() == plugin_path );
+  REQUIRE( cached->score_document(dataset->at(0, 0))
+               == scorer->score_document(dataset->at(0, 0)) );
+
+  scorer.reset();
+  cached.reset();
+  unsetenv("QUICKRANK_PLUGINS_DIR");
+  std::remove(plugin_path.c_str());
+  rmdir(dir.c_str());
+}
+
+TEST_CASE( "Testing CompiledScorer on oblivious trees", "[scoring][compiled]" ) {
+
+  if (!has_compiler()) {
+    WARN( "No compiler available, skipping the compiled scorers" );
+    return;
+  }
+
+  std::mt19937 gen(3);
+  const size_t num_features = 10;
+
+  auto dataset = labelled_dataset(num_features, gen);
+  quickrank::learning::forests::ObliviousMart mart(30, 0.0125, 0, 3, 1, 0);
+  mart.learn(dataset, nullptr,
+             std::make_shared<quickrank::metric::ir::Ndcg>(10), 0, "");
+
+  const std::string dir = "quickrank-test-plugins";
+  setenv("QUICKRANK_PLUGINS_DIR", dir.c_str(), 1);
+
+  auto scorer = quickrank::scoring::CompiledScorer::create(mart, "OBLIVIOUS");
+  REQUIRE( scorer );
+
+  // trees are added by depth, so scores match up to the order of the sum
+  for (size_t i = 0; i < dataset->num_instances(); ++i) {
+    const quickrank::Feature *document = dataset->at(i, 0);
+    REQUIRE( scorer->score_document(document)
+                 == Approx(mart.score_document(document)) );
+  }
+
+  const std::string plugin_path = scorer->plugin_path();
+  scorer.reset();
+  unsetenv("QUICKRANK_PLUGINS_DIR");
+  std::remove(plugin_path.c_str());
+  rmdir(dir.c_str());
+}
@@ -0,0 +1,218 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "catch/include/catch.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "io/binary_model.h"
+#include "scoring/model_handle.h"
+
+namespace {
+
+std::atomic<size_t> num_destroyed(0);
+std::atomic<size_t> num_destroyed_by_caller(0);
+thread_local bool is_caller = false;
+
+/// Scores all the documents with the same value.
+class ConstantEngine: public quickrank::scoring::ScoringEngine {
+ public:
+  explicit ConstantEngine(quickrank::Score value) : value_(value) {
+  }
+
+  virtual ~ConstantEngine() {
+    value_ = -1.0;
+    ++num_destroyed;
+    if (is_caller)
+      ++num_destroyed_by_caller;
+  }
+
+  virtual std::string name() const {
+    return "CONSTANT";
+  }
+
+  virtual quickrank::Score score_document(const quickrank::Feature *d) const {
+    return value_;
+  }
+
+ private:
+  quickrank::Score value_;
+};
+
+}  // namespace
+
+TEST_CASE( "Testing ModelHandle reloads while scoring", "[scoring][reload]" ) {
+
+  using quickrank::scoring::ModelHandle;
+  using quickrank::scoring::ScoringEngine;
+
+  const size_t num_readers = std::max(
+      std::min(std::thread::hardware_concurrency(), 9u), 2u) - 1;
+  const size_t num_reloads = 10;
+  const size_t num_documents = 1000;
+  const size_t batches_per_load = 5;
+
+  num_destroyed = 0;
+  num_destroyed_by_caller = 0;
+  is_caller = true;
+  ModelHandle model(std::make_shared<ConstantEngine>(0.0));
+
+  std::atomic<bool> scoring(true);
+  std::vector<bool> consistent(num_readers, true);
+  std::vector<bool> monotonic(num_readers, true);
+  std::vector<size_t> max_version(num_readers, 0);
+  std::vector<size_t> num_batches(num_readers, 0);
+  std::mutex batches_mutex;
+  std::condition_variable batch_done;
+  std::vector<std::thread> readers;
+  for (size_t r = 0; r < num_readers; ++r)
+    readers.push_back(std::thread([&, r]() {
+      std::vector<quickrank::Feature> documents(num_documents, 0.0f);
+      std::vector<quickrank::Score> scores(num_documents);
+      size_t last_version = 0;
+      while (scoring || max_version[r] < num_reloads) {
+        size_t version = model.version();
+        if (version < last_version)
+          monotonic[r] = false;
+        last_version = version;
+        std::shared_ptr<ScoringEngine> engine = model.get();
+        engine->score_documents(documents.data(), num_documents, 1,
+                                scores.data());
+        engine.reset();
+
+        // a batch is scored by a single model, not older than the version
+        // published before the batch started
+        if (scores.front() < version
+            || std::count(scores.begin(), scores.end(), scores.front())
+                != (long) num_documents)
+          consistent[r] = false;
+        if (scores.front() < max_version[r])
+          monotonic[r] = false;
+        max_version[r] = std::max(max_version[r], (size_t) scores.front());
+
+        std::lock_guard<std::mutex> lock(batches_mutex);
+        ++num_batches[r];
+        batch_done.notify_all();
+      }
+    }));
+
+  // each load completes only after every reader has scored some more
+  // batches, which would never happen if loading stalled the readers (the
+  // wait is bounded only to turn such a stall into a failure)
+  std::vector<bool> scored_while_loading(num_reloads + 1, false);
+  for (size_t v = 1; v <= num_reloads; ++v) {
+    model.reload([&, v]() {
+      std::unique_lock<std::mutex> lock(batches_mutex);
+      const std::vector<size_t> first_batches = num_batches;
+      scored_while_loading[v] = batch_done.wait_for(
+          lock, std::chrono::minutes(1), [&]() {
+            for (size_t r = 0; r < num_readers; ++r)
+              if (num_batches[r] < first_batches[r] + batches_per_load)
+                return false;
+            return true;
+          });
+      return std::make_shared<ConstantEngine>(v);
+    });
+    REQUIRE(model.wait());
+    REQUIRE(scored_while_loading[v]);
+    REQUIRE(model.version() == v);
+    REQUIRE(model.get()->score_document(NULL) == v);
+  }
+
+  // a failed load keeps the current model
+  model.reload([]() {
+    return std::shared_ptr<ScoringEngine>();
+  });
+  REQUIRE_FALSE(model.wait());
+  REQUIRE(model.version() == num_reloads);
+
+  scoring = false;
+  for (auto &reader: readers)
+    reader.join();
+
+  // old models are destroyed once, by the reloading thread or by the last
+  // reader, and the caller never waits for them
+  REQUIRE(num_destroyed == num_reloads);
+  REQUIRE(num_destroyed_by_caller == 0);
+  for (size_t r = 0; r < num_readers; ++r) {
+    REQUIRE(consistent[r]);
+    REQUIRE(monotonic[r]);
+    REQUIRE(max_version[r] == num_reloads);
+  }
+}
+
+TEST_CASE( "Testing ModelHandle reloads with a retained engine",
+           "[scoring][reload]" ) {
+
+  using quickrank::scoring::ModelHandle;
+
+  num_destroyed = 0;
+  std::shared_ptr<ConstantEngine> engine = std::make_shared<ConstantEngine>(
+      0.0);
+  ModelHandle model(engine);
+
+  // a reference kept by the caller does not block the reload
+  model.reload([]() {
+    return std::make_shared<ConstantEngine>(1.0);
+  });
+  REQUIRE(model.wait());
+  REQUIRE(model.version() == 1);
+  REQUIRE(model.get()->score_document(NULL) == 1.0);
+
+  // and the old engine is destroyed by its last holder
+  REQUIRE(num_destroyed == 0);
+  REQUIRE(engine->score_document(NULL) == 0.0);
+  engine.reset();
+  REQUIRE(num_destroyed == 1);
+}
+
+TEST_CASE( "Testing ModelHandle reloads from invalid files",
+           "[scoring][reload]" ) {
+
+  using quickrank::scoring::ModelHandle;
+
+  const std::string filename = "quickrank-test-reload-model.bin";
+  ModelHandle model(std::make_shared<ConstantEngine>(0.0));
+
+  // neither a missing file nor an invalid one stop the server
+  std::remove(filename.c_str());
+  model.reload(filename, "QUICKSCORER", 10);
+  REQUIRE_FALSE(model.wait());
+  {
+    std::ofstream os(filename, std::ofstream::binary);
+    os.write(quickrank::io::BinaryModel::MAGIC,
+             sizeof(quickrank::io::BinaryModel::MAGIC));
+  }
+  model.reload(filename, "QUICKSCORER", 10);
+  REQUIRE_FALSE(model.wait());
+  REQUIRE(model.version() == 0);
+  REQUIRE(model.get()->score_document(NULL) == 0.0);
+
+  std::remove(filename.c_str());
+}
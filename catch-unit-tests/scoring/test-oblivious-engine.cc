@@ -0,0 +1,111 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "catch/include/catch.hpp"
+
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "learning/tree/ensemble.h"
+#include "scoring/oblivious_engine.h"
+
+namespace {
+
+RTNode *oblivious_tree(const std::vector<size_t> &features,
+                       const std::vector<float> &thresholds, size_t level,
+                       std::mt19937 &gen) {
+  std::uniform_real_distribution<double> value(-1.0, 1.0);
+  if (level == features.size())
+    return new RTNode(value(gen));
+  RTNode *left = oblivious_tree(features, thresholds, level + 1, gen);
+  RTNode *right = oblivious_tree(features, thresholds, level + 1, gen);
+  return new RTNode(thresholds[level], features[level], features[level] + 1,
+                    left, right);
+}
+
+}  // namespace
+
+TEST_CASE( "Testing ObliviousEngine", "[scoring][oblivious]" ) {
+
+  std::mt19937 gen(1);
+  const size_t num_trees = 200;
+  const size_t num_features = 30;
+  const size_t num_documents = 1003;
+
+  // depth 0 trees are single leaves
+  Ensemble ensemble;
+  ensemble.set_capacity(num_trees);
+  for (size_t t = 0; t < num_trees; ++t) {
+    std::vector<size_t> features(gen() % 7);
+    std::vector<float> thresholds(features.size());
+    for (size_t l = 0; l < features.size(); ++l) {
+      features[l] = gen() % num_features;
+      thresholds[l] = (gen() % 20) / 10.0f;
+    }
+    ensemble.push(oblivious_tree(features, thresholds, 0, gen),
+                  0.1 + (gen() % 10) / 10.0, 0);
+  }
+
+  std::vector<quickrank::Feature> documents(num_documents * num_features);
+  for (auto &x: documents)
+    x = (gen() % 21) / 10.0f;
+  documents[5 * num_features + 3] = std::numeric_limits<float>::quiet_NaN();
+
+  std::vector<quickrank::Score> expected(num_documents);
+  for (size_t i = 0; i < num_documents; ++i)
+    expected[i] = ensemble.score_instance(&documents[i * num_features]);
+
+  REQUIRE( quickrank::scoring::ObliviousEngine::supports(ensemble) );
+  quickrank::scoring::ObliviousEngine engine(ensemble);
+
+  // scores must match exactly the ones of the tree walk
+  std::vector<quickrank::Score> scores(num_documents);
+  engine.score_documents(documents.data(), num_documents, num_features,
+                         scores.data());
+  REQUIRE( scores == expected );
+  for (size_t i = 0; i < num_documents; ++i)
+    REQUIRE( engine.score_document(&documents[i * num_features])
+                 == expected[i] );
+}
+
+TEST_CASE( "Testing ObliviousEngine on non-oblivious trees",
+           "[scoring][oblivious]" ) {
+
+  // trees are rejected if a level tests different features
+  Ensemble ensemble;
+  ensemble.set_capacity(1);
+  ensemble.push(new RTNode(1.0f, 0, 1,
+                           new RTNode(1.0f, 1, 2, new RTNode(0.1),
+                                      new RTNode(0.2)),
+                           new RTNode(1.0f, 2, 3, new RTNode(0.3),
+                                      new RTNode(0.4))), 1.0, 0);
+  REQUIRE_FALSE( quickrank::scoring::ObliviousEngine::supports(ensemble) );
+
+  // unbalanced trees are not oblivious either
+  Ensemble unbalanced;
+  unbalanced.set_capacity(1);
+  unbalanced.push(new RTNode(1.0f, 0, 1,
+                             new RTNode(1.0f, 1, 2, new RTNode(0.1),
+                                        new RTNode(0.2)),
+                             new RTNode(0.3)), 1.0, 0);
+  REQUIRE_FALSE( quickrank::scoring::ObliviousEngine::supports(unbalanced) );
+}
@@ -0,0 +1,149 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "catch/include/catch.hpp"
+
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "learning/tree/ensemble.h"
+#include "scoring/quickscorer.h"
+#include "scoring/vquickscorer.h"
+#include "scoring/blockwise_quickscorer.h"
+#include "random_models.h"
+
+namespace {
+
+/// Returns an ensemble of randomly weighted trees, with up to the number of
+/// leaves supported by QuickScorer.
+Ensemble quickscorer_ensemble(size_t num_trees, size_t num_features,
+                              std::mt19937 &gen) {
+  return random_ensemble(
+      num_trees, num_features, quickrank::scoring::QuickScorer::MAX_LEAVES,
+      [&gen](size_t) { return 0.1 + (gen() % 10) / 10.0; }, gen);
+}
+
+}  // namespace
+
+TEST_CASE( "Testing QuickScorer", "[scoring][quickscorer]" ) {
+
+  std::mt19937 gen(1);
+  const size_t num_trees = 200;
+  const size_t num_features = 30;
+
+  Ensemble ensemble = quickscorer_ensemble(num_trees, num_features, gen);
+  REQUIRE( quickrank::scoring::QuickScorer::supports(ensemble) );
+
+  quickrank::scoring::QuickScorer quickscorer(ensemble);
+
+  std::vector<quickrank::Feature> document(num_features);
+  for (size_t i = 0; i < 1000; ++i) {
+    for (auto &x: document)
+      x = (gen() % 21) / 10.0f;
+    // scores must match exactly the ones of the tree walk
+    REQUIRE( quickscorer.score_document(document.data())
+                 == ensemble.score_instance(document.data()) );
+  }
+}
+
+TEST_CASE( "Testing QuickScorer on large trees", "[scoring][quickscorer]" ) {
+
+  std::mt19937 gen(1);
+  const size_t num_features = 30;
+
+  // trees with more leaves than a mask are rejected
+  Ensemble ensemble = quickscorer_ensemble(10, num_features, gen);
+  ensemble.set_capacity(11);
+  ensemble.push(random_tree(quickrank::scoring::QuickScorer::MAX_LEAVES + 1,
+                            num_features, gen), 1.0, 0);
+  REQUIRE_FALSE( quickrank::scoring::QuickScorer::supports(ensemble) );
+  ensemble.pop();
+  REQUIRE( quickrank::scoring::QuickScorer::supports(ensemble) );
+}
+
+TEST_CASE( "Testing vectorized QuickScorer", "[scoring][quickscorer]" ) {
+
+  std::mt19937 gen(1);
+  const size_t num_trees = 200;
+  const size_t num_features = 30;
+  const size_t num_documents = 1003;
+
+  Ensemble ensemble = quickscorer_ensemble(num_trees, num_features, gen);
+
+  std::vector<quickrank::Feature> documents(num_documents * num_features);
+  for (auto &x: documents)
+    x = (gen() % 21) / 10.0f;
+  documents[5 * num_features + 3] = std::numeric_limits<float>::quiet_NaN();
+
+  std::vector<quickrank::Score> expected(num_documents);
+  for (size_t i = 0; i < num_documents; ++i)
+    expected[i] = ensemble.score_instance(&documents[i * num_features]);
+
+  // every instruction set, or the best one supported, must match exactly
+  // the scores of the tree walk
+  for (auto instruction_set: {
+      quickrank::scoring::VQuickScorer::InstructionSet::SCALAR,
+      quickrank::scoring::VQuickScorer::InstructionSet::AVX2,
+      quickrank::scoring::VQuickScorer::InstructionSet::AVX512 }) {
+    quickrank::scoring::VQuickScorer vquickscorer(ensemble, instruction_set);
+    REQUIRE( vquickscorer.instruction_set() <= instruction_set );
+
+    std::vector<quickrank::Score> scores(num_documents);
+    vquickscorer.score_documents(documents.data(), num_documents,
+                                 num_features, scores.data());
+    REQUIRE( scores == expected );
+  }
+}
+
+TEST_CASE( "Testing block-wise QuickScorer", "[scoring][quickscorer]" ) {
+
+  std::mt19937 gen(1);
+  const size_t num_trees = 200;
+  const size_t num_features = 30;
+  const size_t num_documents = 1003;
+
+  Ensemble ensemble = quickscorer_ensemble(num_trees, num_features, gen);
+
+  std::vector<quickrank::Feature> documents(num_documents * num_features);
+  for (auto &x: documents)
+    x = (gen() % 21) / 10.0f;
+
+  std::vector<quickrank::Score> expected(num_documents);
+  for (size_t i = 0; i < num_documents; ++i)
+    expected[i] = ensemble.score_instance(&documents[i * num_features]);
+
+  // blocks of trees and batches of documents not dividing the inputs,
+  // and sizes chosen according to the caches
+  quickrank::scoring::BlockWiseQuickScorer small_blocks(ensemble, 7, 50);
+  REQUIRE( small_blocks.num_blocks() == 29 );
+  quickrank::scoring::BlockWiseQuickScorer cache_blocks(ensemble);
+  REQUIRE( cache_blocks.num_blocks() >= 1 );
+
+  for (auto engine: {&small_blocks, &cache_blocks}) {
+    std::vector<quickrank::Score> scores(num_documents);
+    engine->score_documents(documents.data(), num_documents, num_features,
+                            scores.data());
+    REQUIRE( scores == expected );
+    REQUIRE( engine->score_document(&documents[17 * num_features])
+                 == expected[17] );
+  }
+}
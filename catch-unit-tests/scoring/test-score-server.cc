@@ -0,0 +1,147 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "catch/include/catch.hpp"
+
+#include <unistd.h>
+
+#include <thread>
+#include <vector>
+
+#include "scoring/score_server.h"
+
+namespace {
+
+/// Scores documents by the weighted sum of their features.
+class WeightedSum: public quickrank::scoring::ScoringEngine {
+ public:
+  explicit WeightedSum(size_t num_features) : num_features_(num_features) {
+  }
+
+  virtual std::string name() const {
+    return "WEIGHTED_SUM";
+  }
+
+  virtual quickrank::Score score_document(const quickrank::Feature *d) const {
+    quickrank::Score score = 0.0;
+    for (size_t f = 0; f < num_features_; ++f)
+      score += (f + 1.0) * d[f];
+    return score;
+  }
+
+ private:
+  size_t num_features_;
+};
+
+}  // namespace
+
+TEST_CASE( "Testing ScoreServer", "[scoring][server]" ) {
+
+  using quickrank::scoring::ScoreServer;
+  using quickrank::scoring::ScoreClient;
+
+  const size_t num_features = 4;
+  auto engine = std::make_shared<WeightedSum>(num_features);
+  ScoreServer server(engine, num_features);
+
+  int requests[2], responses[2];
+  REQUIRE(pipe(requests) == 0);
+  REQUIRE(pipe(responses) == 0);
+  bool served = false;
+  std::thread worker([&]() {
+    served = server.serve_stream(requests[0], responses[1]);
+    close(requests[0]);
+    close(responses[1]);
+  });
+
+  {
+    ScoreClient client(responses[0], requests[1]);
+    std::vector<quickrank::Score> scores;
+    std::vector<uint32_t> top;
+
+    std::vector<quickrank::Feature> documents = {
+        1.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 1.0f,
+        0.0f, 1.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 1.0f};
+    REQUIRE(client.score(documents.data(), 4, num_features, 0, scores, top)
+                == ScoreServer::STATUS_OK);
+    REQUIRE(scores == std::vector<quickrank::Score>({1.0, 4.0, 2.0, 4.0}));
+
+    // ties are broken by index
+    REQUIRE(client.score(documents.data(), 4, num_features, 3, scores, top)
+                == ScoreServer::STATUS_OK);
+    REQUIRE(top == std::vector<uint32_t>({1, 3, 2}));
+    REQUIRE(client.score(documents.data(), 4, num_features, 10, scores, top)
+                == ScoreServer::STATUS_OK);
+    REQUIRE(top == std::vector<uint32_t>({1, 3, 2, 0}));
+
+    // missing features are zeros
+    std::vector<quickrank::Feature> short_documents = {1.0f, 1.0f, 2.0f, 1.0f};
+    REQUIRE(client.score(short_documents.data(), 2, 2, 0, scores, top)
+                == ScoreServer::STATUS_OK);
+    REQUIRE(scores == std::vector<quickrank::Score>({3.0, 4.0}));
+
+    REQUIRE(client.score(NULL, 0, num_features, 0, scores, top)
+                == ScoreServer::STATUS_OK);
+    REQUIRE(scores.empty());
+  }
+  worker.join();
+
+  REQUIRE(served);
+  REQUIRE(server.num_requests() == 5);
+  REQUIRE(server.num_documents() == 14);
+  REQUIRE(server.latencies().size() == 5);
+}
+
+TEST_CASE( "Testing ScoreServer bad requests", "[scoring][server]" ) {
+
+  using quickrank::scoring::ScoreServer;
+  using quickrank::scoring::ScoreClient;
+
+  const size_t num_features = 4;
+  ScoreServer server(std::make_shared<WeightedSum>(num_features),
+                     num_features);
+
+  int requests[2], responses[2];
+  REQUIRE(pipe(requests) == 0);
+  REQUIRE(pipe(responses) == 0);
+
+  // the server stops without reading the documents, which are small enough
+  // to fit in the pipe
+  std::vector<quickrank::Feature> documents(2 * (num_features + 1), 1.0f);
+  ScoreClient client(responses[0], requests[1]);
+  bool served = true;
+  std::thread worker([&]() {
+    served = server.serve_stream(requests[0], responses[1]);
+    close(responses[1]);
+  });
+  std::vector<quickrank::Score> scores;
+  std::vector<uint32_t> top;
+  uint32_t status = client.score(documents.data(), 2, num_features + 1, 0,
+                                 scores, top);
+  worker.join();
+  close(requests[0]);
+
+  REQUIRE_FALSE(served);
+  REQUIRE(status == ScoreServer::STATUS_BAD_REQUEST);
+  REQUIRE(server.num_requests() == 0);
+}
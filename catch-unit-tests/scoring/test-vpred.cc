@@ -0,0 +1,78 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "catch/include/catch.hpp"
+
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "learning/tree/ensemble.h"
+#include "scoring/vpred.h"
+#include "random_models.h"
+
+TEST_CASE( "Testing VPred", "[scoring][vpred]" ) {
+
+  std::mt19937 gen(1);
+  const size_t num_trees = 200;
+  const size_t num_features = 30;
+  const size_t num_documents = 1003;
+
+  // small trees, to keep their depth below the limit
+  Ensemble ensemble;
+  ensemble.set_capacity(num_trees);
+  for (size_t t = 0; t < num_trees; ++t)
+    ensemble.push(random_tree(1 + gen() % 16, num_features, gen),
+                  0.1 + (gen() % 10) / 10.0, 0);
+
+  std::vector<quickrank::Feature> documents(num_documents * num_features);
+  for (auto &x: documents)
+    x = (gen() % 21) / 10.0f;
+  documents[5 * num_features + 3] = std::numeric_limits<float>::quiet_NaN();
+
+  std::vector<quickrank::Score> expected(num_documents);
+  for (size_t i = 0; i < num_documents; ++i)
+    expected[i] = ensemble.score_instance(&documents[i * num_features]);
+
+  REQUIRE( quickrank::scoring::VPred::supports(ensemble) );
+  quickrank::scoring::VPred vpred(ensemble);
+
+  // scores must match exactly the ones of the tree walk
+  std::vector<quickrank::Score> scores(num_documents);
+  vpred.score_documents(documents.data(), num_documents, num_features,
+                        scores.data());
+  REQUIRE( scores == expected );
+  for (size_t i = 0; i < num_documents; ++i)
+    REQUIRE( vpred.score_document(&documents[i * num_features])
+                 == expected[i] );
+}
+
+TEST_CASE( "Testing VPred on deep trees", "[scoring][vpred]" ) {
+
+  // a chain of splits one level deeper than the limit is rejected
+  RTNode *root = new RTNode(0.0);
+  for (size_t l = 0; l <= quickrank::scoring::VPred::MAX_DEPTH; ++l)
+    root = new RTNode(1.0f, 0, 1, root, new RTNode(1.0));
+  Ensemble ensemble;
+  ensemble.set_capacity(1);
+  ensemble.push(root, 1.0, 0);
+  REQUIRE_FALSE( quickrank::scoring::VPred::supports(ensemble) );
+}
@@ -87,6 +87,15 @@ class Dataset {
   /// \returns The requested QueryResults.
   std::unique_ptr<QueryResults> getQueryResults(size_t i) const;
 
+  /// Returns a view on the i-th QueryResults in the dataset.
+  ///
+  /// Differently from \a getQueryResults, the returned object is not heap
+  /// allocated and it can be cheaply built in tight (parallel) loops.
+  ///
+  /// \param i The i-th query results list of interest.
+  /// \returns The requested QueryResults, sharing the dataset storage.
+  QueryResults getQueryResultsView(size_t i) const;
+
   /// Add a new training instance, i.e., a labeled document, to the dataset.
   ///
   /// \warning Currently the addition works only when data is in HORIZ format.
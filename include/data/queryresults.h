@@ -23,6 +23,8 @@
 
 #include <algorithm>
 
+#include <stdint.h>
+
 #include "types.h"
 
 namespace quickrank {
@@ -60,9 +62,16 @@ class QueryResults {
   /// in descending order of the given \a scores vector
   /// and stores in \a dest the positions of the sorted labels.
   ///
+  /// When a \a cutoff smaller than the number of results is given, only the
+  /// first \a cutoff positions of \a dest are sorted. They are followed by
+  /// the results tied with the last sorted one, and then by the remaining
+  /// ones in unspecified order.
+  ///
   /// \param scores vector of scores used for reverse sorting.
   /// \param dest output of the sorting indexing.
-  void indexing_of_sorted_labels(const Score *scores, size_t *dest) const;
+  /// \param cutoff number of top positions of interest.
+  void indexing_of_sorted_labels(const Score *scores, size_t *dest,
+                                 const size_t cutoff = SIZE_MAX) const;
 
   /// Sorts the element of the current result list
   /// in descending order of the given \a scores vector
@@ -67,11 +67,17 @@ class RankedResults {
     return num_results_;
   }
 
+  /// Returns the original (unsorted) results list.
+  std::shared_ptr<QueryResults> query_results() const {
+    return results_;
+  }
+
  private:
   Label *labels_ = NULL;
   Score *scores_ = NULL;
   size_t num_results_;
   size_t *unmap_ = NULL;
+  std::shared_ptr<QueryResults> results_;
 };
 
 }  // namespace data
@@ -86,6 +86,15 @@ class VerticalDataset {
   /// \returns The requested QueryResults.
   std::unique_ptr<QueryResults> getQueryResults(size_t i) const;
 
+  /// Returns a view on the i-th QueryResults in the dataset.
+  ///
+  /// Differently from \a getQueryResults, the returned object is not heap
+  /// allocated and it can be cheaply built in tight (parallel) loops.
+  ///
+  /// \param i The i-th query results list of interest.
+  /// \returns The requested QueryResults, sharing the dataset storage.
+  QueryResults getQueryResultsView(size_t i) const;
+
   /// Returns the number of features used to represent a document.
   unsigned int num_features() const {
     return num_features_;
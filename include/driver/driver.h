@@ -22,6 +22,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 #include "metric/ir/metric.h"
 #include "learning/ltr_algorithm.h"
@@ -31,6 +32,8 @@
 #include "io/generate_conditional_operators.h"
 #include "io/generate_oblivious.h"
 
+#include "scoring/scoring_engine.h"
+
 #include "paramsmap/paramsmap.h"
 
 namespace quickrank {
@@ -110,12 +113,26 @@ class Driver {
   /// If set save the scores computed for the test set.
   /// \param verbose If True saves an SVML-like file with the score of each ranker in the ensemble.
   /// NB. Works only for ensembles.
+  /// \param test_metrics Additional metrics measured on the test data
+  /// together with \a test_metric.
+  /// \param scoring_engine The engine used to score the test data.
+  /// If null, the test data is scored by \a algo itself.
   static void testing_phase(
       std::shared_ptr<learning::LTR_Algorithm> algo,
       std::shared_ptr<metric::ir::Metric> test_metric,
       std::shared_ptr<quickrank::data::Dataset> test_dataset,
       const std::string scores_filename,
-      const bool detailed_testing);
+      const bool detailed_testing,
+      std::vector<std::shared_ptr<metric::ir::Metric>> test_metrics = {},
+      std::shared_ptr<scoring::ScoringEngine> scoring_engine = nullptr);
+
+  /// Parses a comma separated list of metrics, e.g., "NDCG@10,MAP".
+  /// The cutoff of each metric follows the \@ sign and it is optional.
+  ///
+  /// \param metrics_string The list of metrics.
+  /// \return The parsed metrics.
+  static std::vector<std::shared_ptr<metric::ir::Metric>> parse_metrics(
+      const std::string metrics_string);
 
   static std::shared_ptr<quickrank::data::Dataset> load_dataset(
       const std::string dataset_filename,
@@ -0,0 +1,114 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace quickrank {
+namespace io {
+
+/**
+ * This class implements IO on QuickRank binary model files.
+ *
+ * A binary model file is made of a header and of the data of the model, in
+ * the byte order of the machine where it was written:
+ * \verbatim
+ <file> .=. <magic> <version> <byte order> <info size> <info> <data>
+ <magic> .=. "QRMODEL" followed by a null character
+ <version> .=. <uint32>
+ <byte order> .=. <uint32> 0x01020304
+ <info size> .=. <uint64> number of <key> <value> pairs
+ <info> .=. (<uint32> <key> <uint32> <value>)* padded to 8 bytes
+ \endverbatim
+ * The info pairs are the ones of the \a info element of the XML model, and
+ * the data is written by the model itself, e.g., by Ensemble::write_binary.
+ * Files are mapped in memory, so that data can be used in place and shared
+ * among processes.
+ */
+class BinaryModel {
+ public:
+  /// Maps a binary model file in memory.
+  ///
+  /// \param filename The binary model file.
+  explicit BinaryModel(const std::string &filename);
+
+  /// Maps a binary model file in memory, or returns a null pointer if the
+  /// file cannot be mapped or it is not a valid binary model.
+  ///
+  /// \param filename The binary model file.
+  static std::shared_ptr<BinaryModel> open(const std::string &filename);
+
+  /// Avoid copying the mapping
+  BinaryModel(const BinaryModel &other) = delete;
+  BinaryModel &operator=(const BinaryModel &) = delete;
+
+  virtual ~BinaryModel();
+
+  /// Returns true if the given file starts as a binary model.
+  static bool is_binary_model(const std::string &filename);
+
+  /// Writes the header of a binary model, to be followed by the data.
+  ///
+  /// \param os The output stream, at the beginning of the file.
+  /// \param info The info parameters of the model.
+  static void write_header(
+      std::ostream &os,
+      const std::vector<std::pair<std::string, std::string>> &info);
+
+  /// Returns the info parameters of the model.
+  const std::vector<std::pair<std::string, std::string>> &info() const {
+    return info_;
+  }
+
+  /// Returns the data of the model, aligned to 8 bytes.
+  const char *data() const {
+    return data_;
+  }
+
+  /// Returns the size of the data of the model in bytes.
+  size_t data_size() const {
+    return data_size_;
+  }
+
+  static const char MAGIC[8];
+  static const uint32_t VERSION = 2;
+
+ private:
+  BinaryModel() = default;
+
+  /// Maps the given file, returning false if it is not a valid binary model.
+  bool map(const std::string &filename);
+
+  void *mapping_ = nullptr;
+  size_t mapping_size_ = 0;
+  std::vector<std::pair<std::string, std::string>> info_;
+  const char *data_ = nullptr;
+  size_t data_size_ = 0;
+};
+
+}  // namespace io
+}  // namespace quickrank
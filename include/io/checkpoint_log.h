@@ -0,0 +1,104 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "learning/tree/rtnode.h"
+#include "pugixml/src/pugixml.hpp"
+
+namespace quickrank {
+namespace io {
+
+/**
+ * This class implements an append-only log of the trees added to an
+ * ensemble during training.
+ *
+ * The log is a sequence of XML fragments: the \a info element of the model,
+ * followed by a \a checkpoint element for each checkpoint, holding the trees
+ * added since the previous one. Trees are serialized and appended by a
+ * background thread, so that a checkpoint costs the new trees only and does
+ * not block training. A log can be loaded as a normal model, and a truncated
+ * last checkpoint, e.g., due to a crash, is ignored.
+ */
+class CheckpointLog {
+ public:
+  /// Creates a new log, replacing any existing one.
+  ///
+  /// \param filename The log file name.
+  /// \param model The XML model at the beginning of the training, whose
+  ///        trees, if any, are written as the first checkpoint.
+  CheckpointLog(const std::string &filename, const pugi::xml_document &model);
+
+  /// Avoid copying the log
+  CheckpointLog(const CheckpointLog &other) = delete;
+  CheckpointLog &operator=(const CheckpointLog &) = delete;
+
+  /// Waits for the pending checkpoints to be written.
+  virtual ~CheckpointLog();
+
+  /// Appends a checkpoint with the given trees.
+  /// Trees must not be modified or deleted until the log is destroyed.
+  ///
+  /// \param trees The roots and the weights of the new trees.
+  void append(std::vector<std::pair<const RTNode *, double>> trees);
+
+  /// Returns true if the given file starts as a checkpoint log.
+  static bool is_checkpoint_log(const std::string &filename);
+
+  /// Reads a checkpoint log into an XML model.
+  ///
+  /// \param filename The log file name.
+  /// \param model The XML model with all the trees of the log.
+  /// \return False if the log is not valid.
+  static bool read(const std::string &filename, pugi::xml_document &model);
+
+  static const std::string MAGIC;
+
+ private:
+  struct checkpoint {
+    size_t first_id;
+    std::vector<std::pair<const RTNode *, double>> trees;
+  };
+
+  std::string filename_;
+  std::ofstream os_;
+  size_t num_trees_ = 0;
+
+  std::deque<checkpoint> pending_;
+  bool closing_ = false;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::thread writer_;
+
+  void write_checkpoints();
+};
+
+}  // namespace io
+}  // namespace quickrank
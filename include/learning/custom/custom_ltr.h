@@ -73,6 +73,10 @@ class CustomLTR: public LTR_Algorithm {
   /// Returns the score of a given document.
   virtual Score score_document(const Feature *d) const;
 
+  /// Scores a batch of documents.
+  virtual void score_batch(const Feature *docs, size_t n, size_t stride,
+                           Layout layout, Score *out) const;
+
   /// Return the xml model representing the current object
   virtual pugi::xml_document *get_xml_model() const;
 
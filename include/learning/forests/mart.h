@@ -60,6 +60,10 @@ class Mart: public LTR_Algorithm {
   /// Generates a LTR_Algorithm instance from a previously saved XML model.
   Mart(const pugi::xml_document &model);
 
+  /// Returns false if a previously saved XML model cannot be loaded, i.e.,
+  /// if some tree cannot be parsed or there are more trees than declared.
+  static bool is_valid_xml_model(const pugi::xml_document &model);
+
   virtual ~Mart();
 
   /// Start the learning process.
@@ -76,6 +80,16 @@ class Mart: public LTR_Algorithm {
     return ensemble_model_.score_instance(d, 1);
   }
 
+  /// Returns the number of features needed to score a document.
+  virtual size_t num_features() const {
+    return ensemble_model_.num_features();
+  }
+
+  /// Scores a batch of documents tree by tree, one block of documents at a
+  /// time.
+  virtual void score_batch(const Feature *docs, size_t n, size_t stride,
+                           Layout layout, Score *out) const;
+
   /// Returns the partial scores of a given document, tree.
   /// \param d is a pointer to the document to be evaluated
   /// \param next_fx_offset The offset to the next feature in the data representation.
@@ -106,6 +120,16 @@ class Mart: public LTR_Algorithm {
     return ensemble_model_.get_weights();
   }
 
+  /// Reorders the trees of the ensemble, see \a Ensemble::reorder_trees.
+  bool reorder_trees(const std::vector<size_t> &order) {
+    return ensemble_model_.reorder_trees(order);
+  }
+
+  /// Returns the ensemble of regression trees learnt or loaded.
+  const Ensemble &ensemble() const {
+    return ensemble_model_;
+  }
+
   static const std::string NAME_;
 
  protected:
@@ -134,7 +158,8 @@ class Mart: public LTR_Algorithm {
   ///
   /// \param dataset Dataset to be scored.
   /// \param scores Scores vector to be updated.
-  /// \param tree Last regression tree leartn.
+  /// \param tree Last regression tree leartn, which is expected to be the
+  ///        last tree of the ensemble.
   virtual void update_modelscores(std::shared_ptr<data::Dataset> dataset,
                                   Score *scores, RegressionTree *tree);
   virtual void update_modelscores(std::shared_ptr<data::VerticalDataset> dataset,
@@ -144,6 +169,11 @@ class Mart: public LTR_Algorithm {
 
   virtual bool import_model_state(LTR_Algorithm &other);
 
+  virtual void save_binary(const std::string &model_filename) const;
+
+  virtual bool map_binary_model(
+      std::shared_ptr<const io::BinaryModel> binary_model);
+
  protected:
   float **thresholds_ = NULL;
   size_t *thresholds_size_ = NULL;
@@ -126,6 +126,13 @@ class Rankboost: public LTR_Algorithm {
   /// Returns the score of a given document.
   virtual Score score_document(const Feature *d) const;
 
+  /// Returns the number of features needed to score a document.
+  virtual size_t num_features() const;
+
+  /// Scores a batch of documents weak ranker by weak ranker.
+  virtual void score_batch(const Feature *docs, size_t n, size_t stride,
+                           Layout layout, Score *out) const;
+
   /// Returns the partial scores of a given document, tree.
   /// \param d is a pointer to the document to be evaluated
   virtual std::shared_ptr<std::vector<Score>> partial_scores_document(
@@ -71,6 +71,15 @@ class CoordinateAscent: public LTR_Algorithm {
   /// Returns the score of a given document.
   virtual Score score_document(const Feature *d) const;
 
+  /// Returns the number of features needed to score a document.
+  virtual size_t num_features() const {
+    return best_weights_.size();
+  }
+
+  /// Scores a batch of documents, several dot products at once.
+  virtual void score_batch(const Feature *docs, size_t n, size_t stride,
+                           Layout layout, Score *out) const;
+
   /// Return the xml model representing the current object
   virtual pugi::xml_document *get_xml_model() const;
 
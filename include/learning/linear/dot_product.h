@@ -0,0 +1,54 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#pragma once
+
+#include <vector>
+
+#include "types.h"
+#include "learning/ltr_algorithm.h"
+
+namespace quickrank {
+namespace learning {
+namespace linear {
+
+/// Scores a batch of documents with a linear model.
+///
+/// The dot products of a block of documents are computed at once, feature by
+/// feature, so that the products of the same weight with the features of
+/// different documents can be vectorized. The products of each document are
+/// summed in order of feature, thus giving the same scores of the scalar dot
+/// product.
+///
+/// \param weights The weights of the linear model.
+/// \param docs The first feature of the first document.
+/// \param n The number of documents.
+/// \param stride The distance between two consecutive documents with
+///        Layout::ROW_MAJOR, or between two consecutive features of a
+///        document with Layout::COLUMN_MAJOR.
+/// \param layout The memory layout of the batch.
+/// \param out The array where the \a n scores are stored.
+void dot_product_batch(const std::vector<double> &weights, const Feature *docs,
+                       size_t n, size_t stride, Layout layout, Score *out);
+
+}  // namespace linear
+}  // namespace learning
+}  // namespace quickrank
@@ -22,14 +22,28 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 #include "data/dataset.h"
+#include "io/binary_model.h"
 #include "metric/ir/metric.h"
 #include "pugixml/src/pugixml.hpp"
 
 namespace quickrank {
 namespace learning {
 
+/// Memory layouts of a batch of documents.
+enum class Layout {
+  ROW_MAJOR,    ///< the features of a document are contiguous, as in Dataset
+  COLUMN_MAJOR  ///< the values of a feature are contiguous, as in VerticalDataset
+};
+
+/// Formats of the saved models.
+enum class ModelFormat {
+  XML,    ///< the default, human readable, format
+  BINARY  ///< the format of io::BinaryModel, mapped in memory when loaded
+};
+
 class LTR_Algorithm {
 
  public:
@@ -68,16 +82,40 @@ class LTR_Algorithm {
   ///
   /// \param dataset The dataset to be scored.
   /// \param scores The vector where scores are stored.
-  /// \note Before scoring it invokes the function \a preprocess_dataset.
+  /// \note Documents are scored in batches of \a BATCH_SIZE documents
+  ///       through the function \a score_batch.
   ///       Usually this does not need to be overridden.
   virtual void score_dataset(std::shared_ptr<data::Dataset> dataset,
                              Score *scores) const;
 
+  /// Scores a batch of documents.
+  ///
+  /// \param docs The first feature of the first document.
+  /// \param n The number of documents.
+  /// \param stride The distance between two consecutive documents with
+  ///        Layout::ROW_MAJOR, or between two consecutive features of a
+  ///        document with Layout::COLUMN_MAJOR.
+  /// \param layout The memory layout of the batch.
+  /// \param out The array where the \a n scores are stored.
+  /// \note Scores are the same of \a score_document.
+  virtual void score_batch(const Feature *docs, size_t n, size_t stride,
+                           Layout layout, Score *out) const = 0;
+
+  /// The number of documents scored at once by \a score_dataset.
+  static const size_t BATCH_SIZE = 64;
+
   /// Returns the score of a given document.
   /// \param d is a pointer to the document to be evaluated
   /// \note   Each algorithm has a different implementation.
   virtual Score score_document(const Feature *d) const = 0;
 
+  /// Returns the number of features needed to score a document, i.e., the
+  /// index of the last feature used by the model plus one.
+  /// Default implementation returns 0, meaning it is unknown.
+  virtual size_t num_features() const {
+    return 0;
+  }
+
   /// Returns the partial score of a given document, tree by tree.
   /// \param d is a pointer to the document to be evaluated
   /// \param next_fx_offset The offset to the next feature in the data representation.
@@ -91,14 +129,40 @@ class LTR_Algorithm {
   ///
   /// \param model_filename The output file name.
   /// \param suffix The suffix used to identify partial model saves.
+  /// \note The model is saved in the format set by \a set_model_format.
   virtual void save(std::string model_filename, int suffix = -1) const;
 
-  /// Load a model from a given XML file.
+  /// Sets the format of the models saved by \a save.
+  void set_model_format(ModelFormat format) {
+    model_format_ = format;
+  }
+
+  /// Save the current model to the given file in the binary format.
+  /// Default implementation reports that the format is not supported.
+  ///
+  /// \param model_filename The output file name.
+  virtual void save_binary(const std::string &model_filename) const;
+
+  /// Load a model from a given XML or binary file.
   ///
   /// \param model_filename The input file name.
   static std::shared_ptr<LTR_Algorithm> load_model_from_file(
       std::string model_filename);
 
+  /// Load a model from a given XML or binary file, as \a load_model_from_file
+  /// does, but reports errors and returns a null pointer instead of exiting
+  /// when the file is missing or it is not a valid model.
+  ///
+  /// \param model_filename The input file name.
+  static std::shared_ptr<LTR_Algorithm> try_load_model_from_file(
+      const std::string &model_filename);
+
+  /// Load a LtR model from a given binary model mapped in memory.
+  ///
+  /// \param binary_model The binary model.
+  static std::shared_ptr<LTR_Algorithm> load_model_from_binary(
+      std::shared_ptr<const io::BinaryModel> binary_model);
+
   /// Load a LtR model from a given XML model.
   ///
   /// \param xml_model The input file name.
@@ -117,6 +181,18 @@ class LTR_Algorithm {
     return false;
   };
 
+  /// Uses the data of a binary model, e.g., the trees of an ensemble.
+  /// The model is created from the info parameters of the binary model.
+  /// Default implementation will do nothing (default for models without a
+  /// binary format).
+  ///
+  /// \param binary_model The binary model, kept alive while needed.
+  /// \return bool indicating if the operation was succesfull
+  virtual bool map_binary_model(
+      std::shared_ptr<const io::BinaryModel> binary_model) {
+    return false;
+  }
+
   /// Return the xml model representing the current object
   virtual pugi::xml_document *get_xml_model() const = 0;
 
@@ -141,6 +217,23 @@ class LTR_Algorithm {
     return {};
   }
 
+  /// Sets additional metrics to be measured on the validation dataset at each
+  /// iteration of the learning process, if supported by the algorithm.
+  /// They are only reported and do not affect the learning process.
+  ///
+  /// \param metrics The additional metrics to be measured.
+  void set_validation_metrics(
+      std::vector<std::shared_ptr<metric::ir::Metric>> metrics) {
+    validation_metrics_ = metrics;
+  }
+
+ protected:
+  /// Additional metrics measured on the validation dataset.
+  std::vector<std::shared_ptr<metric::ir::Metric>> validation_metrics_;
+
+  /// The format of the saved models.
+  ModelFormat model_format_ = ModelFormat::XML;
+
  private:
 
   /// The output stream operator.
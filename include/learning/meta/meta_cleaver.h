@@ -81,6 +81,17 @@ class MetaCleaver: public LTR_Algorithm {
     return ltr_algo_->score_document(d);
   }
 
+  /// Returns the number of features needed to score a document.
+  virtual size_t num_features() const {
+    return ltr_algo_ ? ltr_algo_->num_features() : 0;
+  }
+
+  /// Scores a batch of documents with the underlying ranker.
+  virtual void score_batch(const Feature *docs, size_t n, size_t stride,
+                           Layout layout, Score *out) const {
+    ltr_algo_->score_batch(docs, n, stride, layout, out);
+  }
+
   /// Returns the partial scores of a given document, tree.
   /// \param d is a pointer to the document to be evaluated
   /// \param next_fx_offset The offset to the next feature in the data representation.
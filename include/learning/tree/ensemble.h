@@ -21,6 +21,11 @@
  */
 #pragma once
 
+#include <stdint.h>
+#include <memory>
+#include <ostream>
+#include <vector>
+
 #include "learning/tree/rt.h"
 #include "types.h"
 #include "pugixml/src/pugixml.hpp"
@@ -53,6 +58,36 @@ class Ensemble {
   virtual quickrank::Score score_instance(const quickrank::Feature *d,
                                           const size_t offset = 1) const;
 
+  /// Adds the weighted scores of the trees in [first_tree, last_tree) to the
+  /// scores of a batch of documents. Each tree is applied to a block of
+  /// documents before moving to the next one, and the trees of each document
+  /// are summed in the same order of \a score_instance.
+  ///
+  /// \param d The first feature of the first document.
+  /// \param num_instances The number of documents.
+  /// \param instance_offset The distance between two consecutive documents.
+  /// \param offset The distance between two consecutive features of a
+  ///        document.
+  /// \param scores The scores to be updated.
+  void add_scores(const quickrank::Feature *d, size_t num_instances,
+                  size_t instance_offset, size_t offset,
+                  quickrank::Score *scores, size_t first_tree = 0,
+                  size_t last_tree = SIZE_MAX) const;
+
+  /// Builds the flattened representation of the trees used for scoring.
+  /// Pushing or popping trees discards it, and scoring falls back to the
+  /// tree nodes until it is built again.
+  void flatten();
+
+  /// Returns true if scoring uses the flattened representation of the trees.
+  bool is_flat() const {
+    return size > 0 && flat_.num_trees == size;
+  }
+
+  /// Returns the number of features needed to score a document, i.e., the
+  /// index of the last feature used by the trees plus one.
+  size_t num_features() const;
+
   virtual std::shared_ptr<std::vector<quickrank::Score>>
       partial_scores_instance(const quickrank::Feature *d,
                               bool ignore_weights = false,
@@ -60,16 +95,43 @@ class Ensemble {
 
   pugi::xml_node append_xml_model(pugi::xml_node parent) const;
 
+  /// Writes the weights and the flattened trees in the binary model format.
+  /// The stream is expected to be at an offset multiple of 8 bytes.
+  void write_binary(std::ostream &os) const;
+
+  /// Replaces the trees with the ones written by \a write_binary, scoring
+  /// them in place. The trees are rebuilt from the flattened ones only when
+  /// they are accessed by \a getTree or the ensemble is modified.
+  ///
+  /// \param data The binary data, aligned to 8 bytes.
+  /// \param data_size The size of \a data in bytes.
+  /// \param owner The owner of \a data, which is kept alive while needed.
+  /// \return False if \a data is not a valid ensemble.
+  bool map_binary(const char *data, size_t data_size,
+                  std::shared_ptr<const void> owner);
+
   virtual bool update_ensemble_weights(std::vector<double>& weights);
 
   virtual bool filter_out_zero_weighted_trees();
 
+  /// Reorders the trees, so that the i-th tree is the \a order[i]-th tree
+  /// of the previous order. Scores change only by the rounding of their sums.
+  ///
+  /// \param order A permutation of the tree indices.
+  /// \return False if \a order is not a permutation of the trees.
+  bool reorder_trees(const std::vector<size_t> &order);
+
   virtual bool update_ensemble_weights(
       std::vector<double>& weights, bool remove);
 
   virtual std::vector<double> get_weights() const;
 
+  /// Returns the root of a tree.
+  /// \note The trees of a mapped binary model are rebuilt on first access,
+  ///       which is not thread-safe.
   inline RTNode* getTree(int index) const {
+    if (!arr[index].root)
+      arr[index].root = unflatten_node(index, flat_.trees[index].root);
     return arr[index].root;
   }
 
@@ -89,7 +151,7 @@ class Ensemble {
     weighted_tree(const weighted_tree& source) {
       weight = source.weight;
       maxlabel = source.maxlabel;
-      root = new RTNode(*(source.root));
+      root = source.root ? new RTNode(*(source.root)) : nullptr;
     }
 
     RTNode* root = nullptr;
@@ -101,5 +163,83 @@ class Ensemble {
   size_t capacity = 0;
   weighted_tree* arr = nullptr;
 
+  /// The flattened representation of a tree. Nodes are stored in pre-order,
+  /// the child reached by more training samples following its parent (the
+  /// left one when unknown). Children are given by the index of the node in
+  /// the tree, or by the one's complement of the leaf index.
+  struct flat_tree {
+    int32_t root;
+    uint64_t first_node;
+    uint64_t first_leaf;
+  };
+
+  /// The flattened trees built by \a flatten.
+  struct flat_arrays {
+    std::vector<flat_tree> trees;
+    std::vector<uint16_t> features;
+    /// The features of the nodes remapped to their position in used_features.
+    std::vector<uint16_t> dense_features;
+    /// The sorted features used by the trees.
+    std::vector<uint16_t> used_features;
+    std::vector<float> thresholds;
+    std::vector<int32_t> children;  // left and right child of each node
+    /// The probabilities of the left and right child of each node, see
+    /// RTNode::probability.
+    std::vector<float> probabilities;
+    std::vector<double> leaves;
+  };
+
+  /// The flattened trees used for scoring, stored either in flat_arrays_ or
+  /// in a mapped binary model.
+  struct flat_view {
+    size_t num_trees = 0;
+    size_t num_nodes = 0;
+    size_t num_leaves = 0;
+    size_t num_used_features = 0;
+    const flat_tree *trees = nullptr;
+    const uint16_t *features = nullptr;
+    const uint16_t *dense_features = nullptr;
+    const uint16_t *used_features = nullptr;
+    const float *thresholds = nullptr;
+    const int32_t *children = nullptr;
+    const float *probabilities = nullptr;
+    const double *leaves = nullptr;
+  };
+
+  flat_arrays flat_arrays_;
+  flat_view flat_;
+  /// The owner of the mapped flattened trees, if any.
+  std::shared_ptr<const void> mapping_;
+
+  /// Flattens the trees into \a flat, returning false if some feature is
+  /// beyond the range of the flattened nodes.
+  bool flatten_trees(flat_arrays &flat) const;
+
+  int32_t flatten_node(const RTNode *node, flat_arrays &flat,
+                       size_t first_node, size_t first_leaf) const;
+
+  RTNode *unflatten_node(size_t i, int32_t node) const;
+
+  /// Scores a flattened tree. If \a dense is true, \a d holds only the
+  /// used features.
+  quickrank::Score score_flat_tree(size_t i, const quickrank::Feature *d,
+                                   const size_t offset,
+                                   bool dense = false) const {
+    const flat_tree &tree = flat_.trees[i];
+    const uint16_t *features = (dense ? flat_.dense_features : flat_.features)
+        + tree.first_node;
+    const float *thresholds = flat_.thresholds + tree.first_node;
+    const int32_t *children = flat_.children + 2 * tree.first_node;
+    int32_t node = tree.root;
+    while (node >= 0)
+      node = children[2 * node
+          + !(d[features[node] * offset] <= thresholds[node])];
+    return flat_.leaves[tree.first_leaf + ~node];
+  }
+
+  /// Rebuilds the trees of a mapped binary model and releases it.
+  void unmap();
+
+  void reset_flat();
   void reset_state();
 };
@@ -44,6 +44,9 @@ class RTNode {
   RTNode *left = NULL;
   RTNode *right = NULL;
   RTNodeHistogram *hist = NULL;
+  /// The fraction of the training samples of the parent reaching this node,
+  /// negative when unknown.
+  float probability = -1.0f;
 
  private:
   size_t featureidx = uint_max;  //refer the index in the feature matrix
@@ -118,10 +121,10 @@ class RTNode {
     //if(fidx==uint_max or fid==uint_max) exit(7);
     featureidx = fidx, featureid = fid;
   }
-  size_t get_feature_id() {
+  size_t get_feature_id() const {
     return featureid;
   }
-  size_t get_feature_idx() {
+  size_t get_feature_idx() const {
     return featureidx;
   }
 
@@ -132,6 +135,21 @@ class RTNode {
     return featureidx == uint_max;
   }
 
+  /// Returns true if the right child was reached by more training samples
+  /// than the left one. Nodes with unknown probabilities prefer the left one.
+  bool is_right_likely() const {
+    return right->probability > left->probability;
+  }
+
+  /// Sets the probabilities of the children from the number of training
+  /// samples reaching them.
+  void set_children_probability(size_t lcount, size_t rcount) {
+    if (lcount + rcount == 0)
+      return;
+    left->probability = (float) lcount / (lcount + rcount);
+    right->probability = (float) rcount / (lcount + rcount);
+  }
+
   quickrank::Score score_instance(const quickrank::Feature *d,
                                   const size_t next_fx_offset) const {
     /*if (featureidx == uint_max)
@@ -166,4 +184,8 @@ class RTNode {
                                   const std::string &pos = "") const;
 
   static RTNode *parse_xml(const pugi::xml_node &split_xml);
+
+  /// Returns true if \a parse_xml builds a complete tree from the given
+  /// split, i.e., if each split is a leaf or it has a feature and two children.
+  static bool is_valid_xml(const pugi::xml_node &split_xml);
 };
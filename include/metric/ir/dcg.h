@@ -52,10 +52,17 @@ class Dcg: public Metric {
   virtual MetricScore evaluate_result_list(
       const quickrank::data::QueryResults *rl, const Score *scores) const;
 
+  virtual MetricScore evaluate_ranked_list(
+      const quickrank::data::QueryResults *rl, const Score *scores,
+      const size_t *ranking) const;
+
   virtual std::unique_ptr<Jacobian> jacobian(
       std::shared_ptr<data::RankedResults> ranked) const;
 
  protected:
+  /// Precomputes the gain of every document.
+  virtual void precompute(PreparedDataset &pd) const;
+
   /// Computes the DCG\@K of a given array of labels.
   /// \param rl The given array of labels.
   /// \return DCG\@K for computed on the given labels.
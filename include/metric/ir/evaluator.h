@@ -0,0 +1,99 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#pragma once
+
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "metric/ir/metric.h"
+#include "types.h"
+
+namespace quickrank {
+namespace metric {
+namespace ir {
+
+/**
+ * This class measures a set of metrics, possibly with different cut-offs,
+ * in a single pass over a dataset.
+ *
+ * Every results list is ranked only once, up to the largest cut-off of the
+ * metrics, and the ranking is shared by all the metrics.
+ */
+class Evaluator {
+ public:
+  /// Creates a new evaluator of the given metrics.
+  ///
+  /// \param metrics The metrics to be measured.
+  explicit Evaluator(std::vector<std::shared_ptr<Metric>> metrics);
+
+  /// Returns the number of metrics measured.
+  size_t num_metrics() const {
+    return metrics_.size();
+  }
+
+  /// Returns the i-th metric measured.
+  std::shared_ptr<Metric> metric(size_t i) const {
+    return metrics_[i];
+  }
+
+  /// Precomputes the per-query data of all the metrics on the given dataset.
+  ///
+  /// \param dataset The dataset to be evaluated later on.
+  void prepare(const std::shared_ptr<data::Dataset> dataset);
+  void prepare(const std::shared_ptr<data::VerticalDataset> dataset);
+
+  /// Measures all the metrics on the given dataset.
+  ///
+  /// \param dataset The dataset to be evaluated.
+  /// \param scores The scores of all the documents in \a dataset.
+  /// \return The quality score of the dataset according to each metric,
+  ///         the same returned by \a Metric::evaluate_dataset up to the
+  ///         order of documents with tied scores.
+  std::vector<MetricScore> evaluate_dataset(
+      const std::shared_ptr<data::Dataset> dataset, const Score *scores) const;
+  std::vector<MetricScore> evaluate_dataset(
+      const std::shared_ptr<data::VerticalDataset> dataset,
+      const Score *scores) const;
+
+ private:
+  std::vector<std::shared_ptr<Metric>> metrics_;
+
+  /// The largest cut-off of the metrics.
+  size_t max_cutoff_;
+
+  template<class D>
+  std::vector<MetricScore> evaluate(const D &dataset,
+                                    const Score *scores) const;
+
+  /// The output stream operator.
+  /// Prints the short names of the metrics, e.g., "NDCG@10 MAP".
+  friend std::ostream &operator<<(std::ostream &os, const Evaluator &e) {
+    return e.put(os);
+  }
+
+  std::ostream &put(std::ostream &os) const;
+};
+
+}  // namespace ir
+}  // namespace metric
+}  // namespace quickrank
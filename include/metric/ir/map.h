@@ -51,10 +51,21 @@ class Map: public Metric {
   virtual MetricScore evaluate_result_list(
       const quickrank::data::QueryResults *rl, const Score *scores) const;
 
+  virtual MetricScore evaluate_ranked_list(
+      const quickrank::data::QueryResults *rl, const Score *scores,
+      const size_t *ranking) const;
+
+  /// Computes the Jacobian matrix in closed form, in O(1) for each pair of
+  /// documents, see also \a swap_deltas.
   virtual std::unique_ptr<Jacobian> jacobian(
       std::shared_ptr<data::RankedResults> ranked) const;
 
+  virtual std::unique_ptr<SwapDeltas> swap_deltas(
+      std::shared_ptr<data::RankedResults> ranked) const;
+
  protected:
+  /// Precomputes the number of relevant documents of every query.
+  virtual void precompute(PreparedDataset &pd) const;
 
  private:
   friend std::ostream &operator<<(std::ostream &os, const Map &map) {
@@ -24,6 +24,7 @@
 #include <iostream>
 #include <climits>
 #include <memory>
+#include <vector>
 
 #include <stdint.h>
 
@@ -45,6 +46,22 @@ class Metric {
   /// This should be used when no cut-off on the results list is required.
   static const size_t NO_CUTOFF = SIZE_MAX;
 
+  /// Computes the metric changes caused by swapping two documents of a ranked
+  /// list, one row of the Jacobian at a time, so that the full matrix does
+  /// not need to be stored.
+  class SwapDeltas {
+   public:
+    virtual ~SwapDeltas() {
+    }
+
+    /// Stores in \a deltas[j], for every rank j > \a i, the metric change
+    /// caused by swapping the documents at ranks \a i and j.
+    ///
+    /// \param i The rank of the first document of the swap.
+    /// \param deltas Output array with one entry per document of the list.
+    virtual void row(size_t i, double *deltas) const = 0;
+  };
+
   /// Creates a new metric with the specified cut-off threshold.
   ///
   /// \param k The cut-off threshold.
@@ -66,6 +83,17 @@ class Metric {
     cutoff_ = k == 0 ? NO_CUTOFF : k;
   }
 
+  /// Precomputes the per-query data needed by the Metric on the given dataset,
+  /// e.g., the ideal DCG of every query, so that subsequent evaluations of
+  /// results lists of the dataset only need to rank the scores.
+  ///
+  /// Labels of the dataset must not change after this call, while a change of
+  /// the cut-off simply disables the precomputed data.
+  ///
+  /// \param dataset The dataset to be evaluated later on.
+  void prepare(const std::shared_ptr<data::Dataset> dataset);
+  void prepare(const std::shared_ptr<data::VerticalDataset> dataset);
+
   /// Measures the quality of the given results list according to the Metric.
   ///
   /// \param rl A results list.
@@ -74,35 +102,89 @@ class Metric {
   virtual MetricScore evaluate_result_list(
       const quickrank::data::QueryResults *rl, const Score *scores) const = 0;
 
+  /// Measures the quality of a results list already ranked by score.
+  ///
+  /// This allows several metrics to share the ranking of a results list.
+  /// The default implementation ignores \a ranking and ranks the list again.
+  ///
+  /// \param rl A results list.
+  /// \param scores a list of scores
+  /// \param ranking The positions of the results sorted by descending score,
+  ///        as given by \a QueryResults::indexing_of_sorted_labels with a
+  ///        cut-off not smaller than the one of the Metric.
+  /// \return The quality score of the result list.
+  virtual MetricScore evaluate_ranked_list(
+      const quickrank::data::QueryResults *rl, const Score *scores,
+      const size_t *ranking) const {
+    return evaluate_result_list(rl, scores);
+  }
+
+  /// Combines the sum of the per-query results of a dataset into the score of
+  /// the dataset. The default implementation averages over queries.
+  ///
+  /// \param sum The sum of the quality scores of the queries of the dataset.
+  /// \param num_queries The number of queries in the dataset.
+  /// \param num_instances The number of documents in the dataset.
+  /// \return The quality score of the dataset.
+  virtual MetricScore dataset_score(MetricScore sum, size_t num_queries,
+                                    size_t num_instances) const {
+    return num_queries == 0 ? 0.0 : sum / (MetricScore) num_queries;
+  }
+
+  /// Measures the average quality of the queries in the given dataset.
+  ///
+  /// Queries are evaluated in parallel, while the per-query results are
+  /// summed in query order, so that the returned value does not depend
+  /// on the number of threads used.
+  ///
+  /// \param dataset The dataset to be evaluated.
+  /// \param scores The scores of all the documents in \a dataset.
+  /// \return The average quality score of the dataset.
   virtual MetricScore evaluate_dataset(
       const std::shared_ptr<data::Dataset> dataset, const Score *scores) const {
-    if (dataset->num_queries() == 0)
-      return 0.0;
-    MetricScore avg_score = 0.0;
-
-//    #pragma omp parallel for reduction(+:avg_score)
-    for (size_t q = 0; q < dataset->num_queries(); q++) {
-      std::shared_ptr<data::QueryResults> r = dataset->getQueryResults(q);
-      avg_score += evaluate_result_list(r.get(), scores);
-      scores += r->num_results();
-    }
-    avg_score /= (MetricScore) dataset->num_queries();
-    return avg_score;
+    return dataset_score(sum_result_lists(*dataset, scores),
+                         dataset->num_queries(), dataset->num_instances());
   }
 
   virtual MetricScore evaluate_dataset(
       const std::shared_ptr<data::VerticalDataset> dataset,
       const Score *scores) const {
-    if (dataset->num_queries() == 0)
-      return 0.0;
-    MetricScore avg_score = 0.0;
-    for (unsigned int q = 0; q < dataset->num_queries(); q++) {
-      std::shared_ptr<data::QueryResults> r = dataset->getQueryResults(q);
-      avg_score += evaluate_result_list(r.get(), scores);
-      scores += r->num_results();
-    }
-    avg_score /= (MetricScore) dataset->num_queries();
-    return avg_score;
+    return dataset_score(sum_result_lists(*dataset, scores),
+                         dataset->num_queries(), dataset->num_instances());
+  }
+
+  /// Measures the average quality of several candidate scorings of the
+  /// queries in the given dataset.
+  ///
+  /// The dataset is visited once, and every query is evaluated against all
+  /// the candidates while its labels and precomputed data are in cache.
+  /// The result of each candidate is the same as \a evaluate_dataset.
+  ///
+  /// \param dataset The dataset to be evaluated.
+  /// \param scores \a num_candidates consecutive vectors of scores, each one
+  ///        storing the scores of all the documents in \a dataset.
+  /// \param num_candidates The number of candidate scorings.
+  /// \param metric_scores Output, the average quality score of every
+  ///        candidate (\a num_candidates values).
+  virtual void evaluate_dataset_batch(
+      const std::shared_ptr<data::Dataset> dataset, const Score *scores,
+      size_t num_candidates, MetricScore *metric_scores) const {
+    sum_result_lists(*dataset, scores, num_candidates, metric_scores);
+    for (size_t p = 0; p < num_candidates; p++)
+      metric_scores[p] = dataset_score(metric_scores[p],
+                                       dataset->num_queries(),
+                                       dataset->num_instances());
+  }
+
+  virtual void evaluate_dataset_batch(
+      const std::shared_ptr<data::VerticalDataset> dataset,
+      const Score *scores, size_t num_candidates,
+      MetricScore *metric_scores) const {
+    sum_result_lists(*dataset, scores, num_candidates, metric_scores);
+    for (size_t p = 0; p < num_candidates; p++)
+      metric_scores[p] = dataset_score(metric_scores[p],
+                                       dataset->num_queries(),
+                                       dataset->num_instances());
   }
 
   /// Computes the Jacobian matrix.
@@ -136,11 +218,98 @@ class Metric {
     return jacobian;
   }
 
+  /// Returns an object computing the rows of the Jacobian matrix of the given
+  /// ranked list on demand.
+  ///
+  /// The default implementation computes and stores the full \a jacobian.
+  /// \param ranked A ranked results list.
+  /// \return A smart-pointer to the swap deltas of \a ranked.
+  virtual std::unique_ptr<SwapDeltas> swap_deltas(
+      std::shared_ptr<data::RankedResults> ranked) const;
+
+ protected:
+
+  /// Per-query data precomputed on a dataset by \a prepare.
+  struct PreparedDataset {
+    /// The dataset the data was computed on.
+    std::weak_ptr<const void> dataset;
+    /// The labels of the dataset, used to find the query of a results list.
+    const Label *labels = NULL;
+    size_t num_instances = 0;
+    /// The cut-off of the metric when the data was computed.
+    size_t cutoff = NO_CUTOFF;
+    /// The offsets of the queries in the dataset (num queries + 1 values).
+    std::vector<size_t> offsets;
+    /// Metric specific per-query values, e.g., the ideal DCG.
+    std::vector<MetricScore> query_values;
+    /// Metric specific per-document gains.
+    std::vector<double> gains;
+  };
+
+  /// Fills the metric specific data of a prepared dataset.
+  /// The default implementation does nothing.
+  ///
+  /// \param pd The prepared dataset, labels and offsets are already set.
+  virtual void precompute(PreparedDataset &pd) const {
+  }
+
+  /// Looks for the precomputed data of the given results list.
+  ///
+  /// \param rl A results list of a prepared dataset.
+  /// \param q Output, the index of the query of \a rl in the dataset.
+  /// \return The prepared dataset \a rl belongs to, or NULL if not found.
+  const PreparedDataset *find_prepared(const data::QueryResults *rl,
+                                       size_t &q) const;
+
+  /// Evaluates every query of the given dataset and returns the sum of the
+  /// per-query results.
+  ///
+  /// The evaluation of the queries is carried out in parallel, and the sum
+  /// is computed afterwards in query order to make it deterministic.
+  template<class D>
+  MetricScore sum_result_lists(const D &dataset, const Score *scores) const {
+    MetricScore sum;
+    sum_result_lists(dataset, scores, 1, &sum);
+    return sum;
+  }
+
+  /// Evaluates every query of the given dataset against \a num_candidates
+  /// consecutive vectors of scores, and stores in \a sums the sum of the
+  /// per-query results of every candidate.
+  template<class D>
+  void sum_result_lists(const D &dataset, const Score *scores,
+                        size_t num_candidates, MetricScore *sums) const {
+    const size_t num_queries = dataset.num_queries();
+    const size_t num_instances = dataset.num_instances();
+    std::vector<MetricScore> query_scores(num_queries * num_candidates);
+
+    #pragma omp parallel for schedule(dynamic, 16)
+    for (size_t q = 0; q < num_queries; q++) {
+      data::QueryResults r = dataset.getQueryResultsView(q);
+      const Score *query_scores_p = scores + dataset.offset(q);
+      for (size_t p = 0; p < num_candidates; p++)
+        query_scores[q * num_candidates + p] = evaluate_result_list(
+            &r, query_scores_p + p * num_instances);
+    }
+
+    for (size_t p = 0; p < num_candidates; p++) {
+      sums[p] = 0.0;
+      for (size_t q = 0; q < num_queries; q++)
+        sums[p] += query_scores[q * num_candidates + p];
+    }
+  }
+
  private:
 
   /// The metric cutoff.
   size_t cutoff_;
 
+  /// The datasets prepared so far.
+  std::vector<std::shared_ptr<PreparedDataset>> prepared_;
+
+  template<class D>
+  void prepare_dataset(const std::shared_ptr<D> dataset);
+
   /// The output stream operator.
   friend std::ostream &operator<<(std::ostream &os, const Metric &m) {
     return m.put(os);
@@ -58,11 +58,19 @@ class Ndcg: public Dcg {
   virtual MetricScore evaluate_result_list(
       const quickrank::data::QueryResults *rl, const Score *scores) const;
 
+  virtual MetricScore evaluate_ranked_list(
+      const quickrank::data::QueryResults *rl, const Score *scores,
+      const size_t *ranking) const;
+
   virtual std::unique_ptr<Jacobian> jacobian(
       std::shared_ptr<data::RankedResults> ranked) const;
 
  protected:
+  /// Precomputes the gain of every document and the IDCG\@K of every query.
+  virtual void precompute(PreparedDataset &pd) const;
+
   /// Computes the IDCG\@K of a given list of labels.
+  /// The precomputed value is used when \a rl belongs to a prepared dataset.
   /// \param rl The given results list. Only labels are actually used.
   /// \return IDCG\@K for computed on the given labels.
   MetricScore compute_idcg(const quickrank::data::QueryResults *rl) const;
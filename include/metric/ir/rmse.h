@@ -55,13 +55,10 @@ class Rmse: public Metric {
   virtual std::unique_ptr<Jacobian> jacobian(
       std::shared_ptr<data::RankedResults> ranked) const;
 
-  virtual MetricScore evaluate_dataset(
-      const std::shared_ptr<data::Dataset> dataset,
-      const Score *scores) const;
-
-  virtual MetricScore evaluate_dataset(
-      const std::shared_ptr<data::VerticalDataset> dataset,
-      const Score *scores) const;
+  /// Returns the root of the mean squared error over all the documents,
+  /// negated so that higher is better.
+  virtual MetricScore dataset_score(MetricScore sum, size_t num_queries,
+                                    size_t num_instances) const;
 
  protected:
 
@@ -58,16 +58,26 @@ class Tndcg: public Ndcg {
   virtual MetricScore evaluate_result_list(
       const quickrank::data::QueryResults *rl, const Score *scores) const;
 
+  virtual MetricScore evaluate_ranked_list(
+      const quickrank::data::QueryResults *rl, const Score *scores,
+      const size_t *ranking) const;
+
   virtual std::unique_ptr<Jacobian> jacobian(
       std::shared_ptr<data::RankedResults> ranked) const;
 
+  /// Computes the tie-group discount weights once per ranked list, so that
+  /// every swap delta costs O(1) and no Jacobian matrix is stored.
+  virtual std::unique_ptr<SwapDeltas> swap_deltas(
+      std::shared_ptr<data::RankedResults> ranked) const;
+
  protected:
   /// Computes the TNDCG\@K of a given list of labels.
   /// \param rl The given results list. Only labels are actually used.
   /// \param scores The scores to be used to re-order the result list.
+  /// \param idx The positions of the results sorted by descending score.
   /// \return TNDCG\@K for computed on the given labels.
   MetricScore compute_tndcg(const quickrank::data::QueryResults *rl,
-                            const Score *scores) const;
+                            const Score *scores, const size_t *idx) const;
 
  private:
   friend std::ostream &operator<<(std::ostream &os, const Tndcg &tndcg) {
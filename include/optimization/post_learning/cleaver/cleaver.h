@@ -159,6 +159,9 @@ class Cleaver: public PostLearningOptimization {
   }
 
  protected:
+  /// Number of candidate scorings evaluated together by the pruning methods.
+  static const size_t CANDIDATES_BLOCK_SIZE;
+
   double pruning_rate_;
   unsigned int estimators_to_prune_;
   std::shared_ptr<learning::linear::LineSearch> lineSearch_;
@@ -0,0 +1,151 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "data/dataset.h"
+#include "learning/tree/ensemble.h"
+#include "scoring/scoring_engine.h"
+#include "scoring/vquickscorer.h"
+
+namespace quickrank {
+namespace scoring {
+
+/**
+ * This engine scores the documents of a query within a budget of trees or of
+ * time, for protecting the latency of queries under overload.
+ *
+ * Trees are scored in order, a block of trees at a time with VQuickScorer,
+ * and scoring stops after the first \a max_trees trees or after the first
+ * block exceeding \a max_time, so that all the documents of the query are
+ * scored by the same trees and the best-effort ranking is given by their
+ * partial scores. The ensemble should thus be reordered by decreasing
+ * importance of its trees when the model is loaded, e.g., by means of
+ * \a order_by_weight or \a order_by_variance.
+ *
+ * \note Each call to \a score_documents is assumed to score the candidate
+ *       documents of one query.
+ */
+class AnytimeEngine: public ScoringEngine {
+ public:
+  /// Creates a new engine from the given ensemble.
+  ///
+  /// \param ensemble The ensemble of regression trees, in scoring order.
+  /// \param max_trees The budget of trees of each query.
+  /// \param max_time The budget of time of each query, in seconds (0 means
+  ///        no limit).
+  /// \param trees_block_size The number of trees scored between two checks
+  ///        of the budget of time.
+  /// \note Trees are limited to \a QuickScorer::MAX_LEAVES leaves.
+  explicit AnytimeEngine(const Ensemble &ensemble, size_t max_trees = SIZE_MAX,
+                         double max_time = 0.0,
+                         size_t trees_block_size = DEFAULT_TREES_BLOCK_SIZE);
+
+  virtual ~AnytimeEngine() {
+  }
+
+  /// Returns the name of the scoring engine.
+  virtual std::string name() const {
+    return NAME_;
+  }
+
+  static const std::string NAME_;
+
+  virtual Score score_document(const Feature *d) const;
+
+  virtual void score_documents(const Feature *d, size_t num_documents,
+                               size_t stride, Score *scores) const;
+
+  /// Scores the queries of a given dataset in parallel.
+  virtual void score_dataset(std::shared_ptr<data::Dataset> dataset,
+                             Score *scores) const;
+
+  /// Returns the number of trees of the ensemble.
+  size_t num_trees() const {
+    return num_trees_;
+  }
+
+  /// Returns the number of trees evaluated since the last reset.
+  uint64_t trees_evaluated() const {
+    return trees_evaluated_;
+  }
+
+  /// Returns the number of documents scored since the last reset.
+  uint64_t documents_scored() const {
+    return documents_scored_;
+  }
+
+  /// Returns the number of calls to \a score_documents stopped by the budget
+  /// of time since the last reset.
+  uint64_t queries_interrupted() const {
+    return queries_interrupted_;
+  }
+
+  /// Resets the counters of trees evaluated, documents scored and queries
+  /// interrupted.
+  void reset_statistics() const {
+    trees_evaluated_ = 0;
+    documents_scored_ = 0;
+    queries_interrupted_ = 0;
+  }
+
+  /// Returns the trees of the ensemble by decreasing range of their weighted
+  /// outputs, i.e., the weight times the difference between the highest and
+  /// the lowest leaf, an upper bound of their effect on rankings.
+  static std::vector<size_t> order_by_weight(const Ensemble &ensemble);
+
+  /// Returns the trees of the ensemble by decreasing variance of their
+  /// weighted outputs among the documents of the same query, averaged over
+  /// the queries of a validation dataset.
+  static std::vector<size_t> order_by_variance(
+      const Ensemble &ensemble, std::shared_ptr<data::Dataset> validation);
+
+  /// Returns the mean NDCG@k of the partial scores given by the first
+  /// \a budgets[i] trees of the ensemble, for each i.
+  ///
+  /// \param ensemble The ensemble of regression trees, in scoring order.
+  /// \param budgets The increasing budgets of trees.
+  /// \param dataset The dataset where quality is measured.
+  /// \param k The cutoff of NDCG.
+  static std::vector<MetricScore> quality_curve(
+      const Ensemble &ensemble, const std::vector<size_t> &budgets,
+      std::shared_ptr<data::Dataset> dataset, size_t k);
+
+  static const size_t DEFAULT_TREES_BLOCK_SIZE = 16;
+
+ private:
+  std::vector<std::unique_ptr<VQuickScorer>> blocks_;
+  std::vector<size_t> block_sizes_;
+  size_t num_trees_;
+  double max_time_;
+
+  mutable std::atomic<uint64_t> trees_evaluated_;
+  mutable std::atomic<uint64_t> documents_scored_;
+  mutable std::atomic<uint64_t> queries_interrupted_;
+};
+
+}  // namespace scoring
+}  // namespace quickrank
@@ -0,0 +1,93 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "learning/tree/ensemble.h"
+#include "scoring/scoring_engine.h"
+#include "scoring/vquickscorer.h"
+
+namespace quickrank {
+namespace scoring {
+
+/**
+ * This engine implements the block-wise QuickScorer algorithm, suited to
+ * ensembles whose data do not fit in the CPU caches.
+ *
+ * The ensemble is split into blocks of consecutive trees, each one scored
+ * by a \a VQuickScorer, and the documents into batches. Each batch of
+ * documents is scored against one block of trees at a time, so that the
+ * data of the block are read from the cache rather than from memory for all
+ * the documents of the batch. Partial scores are accumulated in tree order,
+ * hence scores are the same of the whole ensemble.
+ */
+class BlockWiseQuickScorer: public ScoringEngine {
+ public:
+  /// Creates a new engine from the given ensemble.
+  ///
+  /// \param ensemble The ensemble of regression trees.
+  /// \param trees_block_size The number of trees in each block. If 0, blocks
+  ///        are sized to fit in half of the L2 cache.
+  /// \param documents_block_size The number of documents in each batch.
+  ///        If 0, batches are sized to fit in a quarter of the last level
+  ///        cache.
+  explicit BlockWiseQuickScorer(const Ensemble &ensemble,
+                                size_t trees_block_size = 0,
+                                size_t documents_block_size = 0);
+
+  virtual ~BlockWiseQuickScorer() {
+  }
+
+  /// Returns the name of the scoring engine.
+  virtual std::string name() const {
+    return NAME_;
+  }
+
+  static const std::string NAME_;
+
+  /// Returns the number of blocks of trees.
+  size_t num_blocks() const {
+    return blocks_.size();
+  }
+
+  virtual Score score_document(const Feature *d) const;
+
+  virtual void score_documents(const Feature *d, size_t num_documents,
+                               size_t stride, Score *scores) const;
+
+  /// Scores all the documents of a given dataset, by scoring batches of
+  /// documents in parallel.
+  virtual void score_dataset(std::shared_ptr<data::Dataset> dataset,
+                             Score *scores) const;
+
+ private:
+  std::vector<std::unique_ptr<VQuickScorer>> blocks_;
+  size_t documents_block_size_;
+
+  /// Returns the number of documents in each batch.
+  size_t documents_block_size(size_t stride) const;
+};
+
+}  // namespace scoring
+}  // namespace quickrank
@@ -0,0 +1,159 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "data/dataset.h"
+#include "learning/tree/ensemble.h"
+#include "scoring/scoring_engine.h"
+#include "scoring/vquickscorer.h"
+
+namespace quickrank {
+namespace scoring {
+
+/**
+ * This engine scores the documents of a query with an early-exit cascade,
+ * for the applications needing only the top \a k documents of each query.
+ *
+ * The trees of the ensemble are split into segments by sentinels, and each
+ * segment is scored with VQuickScorer. After each sentinel, a document exits
+ * the cascade if its partial score is lower than the k-th highest partial
+ * score by more than the margin of the sentinel, since it is unlikely to
+ * enter the top k. Exited documents are ranked last, with a score of minus
+ * infinity, while the others get the same score of the whole ensemble. At
+ * least \a k documents reach the end of the cascade, hence the top k are
+ * always ranked.
+ *
+ * The margins are learnt on validation data by \a learn_margins, so that the
+ * loss of NDCG@k of the cascade is bounded.
+ *
+ * \note Each call to \a score_documents is assumed to score the candidate
+ *       documents of one query.
+ *
+ * See: B. B. Cambazoglu, H. Zaragoza, O. Chapelle, J. Chen, C. Liao,
+ * Z. Zheng, and J. Degenhardt. Early exit optimizations for additive machine
+ * learned ranking systems. WSDM 2010.
+ */
+class CascadeEngine: public ScoringEngine {
+ public:
+  /// Creates a new engine from the given ensemble.
+  ///
+  /// \param ensemble The ensemble of regression trees.
+  /// \param sentinels The increasing positions of the sentinels, i.e., the
+  ///        number of trees scored before each of them.
+  /// \param k The number of top documents of each query.
+  /// \param margins The margin of each sentinel. Infinite margins disable
+  ///        their sentinel.
+  /// \note Trees are limited to \a QuickScorer::MAX_LEAVES leaves.
+  CascadeEngine(const Ensemble &ensemble, const std::vector<size_t> &sentinels,
+                size_t k, const std::vector<double> &margins);
+
+  virtual ~CascadeEngine() {
+  }
+
+  /// Returns the name of the scoring engine.
+  virtual std::string name() const {
+    return NAME_;
+  }
+
+  static const std::string NAME_;
+
+  /// Scores the document with the whole ensemble.
+  virtual Score score_document(const Feature *d) const;
+
+  virtual void score_documents(const Feature *d, size_t num_documents,
+                               size_t stride, Score *scores) const;
+
+  /// Scores the queries of a given dataset in parallel.
+  virtual void score_dataset(std::shared_ptr<data::Dataset> dataset,
+                             Score *scores) const;
+
+  /// Returns the number of trees of the ensemble.
+  size_t num_trees() const {
+    return num_trees_;
+  }
+
+  const std::vector<size_t> &sentinels() const {
+    return sentinels_;
+  }
+
+  const std::vector<double> &margins() const {
+    return margins_;
+  }
+
+  /// Returns the number of trees evaluated since the last reset.
+  uint64_t trees_evaluated() const {
+    return trees_evaluated_;
+  }
+
+  /// Returns the number of documents scored since the last reset.
+  uint64_t documents_scored() const {
+    return documents_scored_;
+  }
+
+  /// Resets the counters of trees evaluated and documents scored.
+  void reset_statistics() const {
+    trees_evaluated_ = 0;
+    documents_scored_ = 0;
+  }
+
+  /// Returns \a num_segments - 1 sentinels splitting \a num_trees trees into
+  /// segments of the same size.
+  static std::vector<size_t> even_sentinels(size_t num_trees,
+                                            size_t num_segments);
+
+  /// Learns the margins of the sentinels on a validation dataset, one
+  /// sentinel at a time, as the smallest margin such that the mean NDCG@k
+  /// of the cascade up to that sentinel is at most \a max_loss lower than
+  /// the one of the whole ensemble.
+  ///
+  /// \param ensemble The ensemble of regression trees.
+  /// \param sentinels The increasing positions of the sentinels.
+  /// \param k The number of top documents of each query.
+  /// \param validation The validation dataset.
+  /// \param max_loss The maximum loss of mean NDCG@k.
+  /// \return The margin of each sentinel.
+  static std::vector<double> learn_margins(
+      const Ensemble &ensemble, const std::vector<size_t> &sentinels,
+      size_t k, std::shared_ptr<data::Dataset> validation, double max_loss);
+
+  /// Number of candidate margins tried for each sentinel by
+  /// \a learn_margins, taken at evenly spaced quantiles of the score gaps.
+  static const size_t NUM_CANDIDATE_MARGINS = 64;
+
+ private:
+  std::vector<std::unique_ptr<VQuickScorer>> segments_;
+  std::vector<size_t> sentinels_;
+  std::vector<double> margins_;
+  size_t k_;
+  size_t num_trees_;
+
+  mutable std::atomic<uint64_t> trees_evaluated_;
+  mutable std::atomic<uint64_t> documents_scored_;
+};
+
+}  // namespace scoring
+}  // namespace quickrank
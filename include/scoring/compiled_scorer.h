@@ -0,0 +1,98 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "learning/ltr_algorithm.h"
+#include "scoring/scoring_engine.h"
+
+namespace quickrank {
+namespace scoring {
+
+/**
+ * This engine scores documents with the C++ code produced by one of the code
+ * generators, compiled at run time into a shared object and loaded as a
+ * plugin, so that no manual rebuild of \a quickscore is needed.
+ *
+ * Shared objects are cached by a hash of the model and of the generator, in
+ * the directory given by the QUICKRANK_PLUGINS_DIR environment variable or
+ * in a \a quickrank-plugins directory of the system temporary one. The
+ * compiler is given by the CXX environment variable, or defaults to \a c++.
+ */
+class CompiledScorer: public ScoringEngine {
+ public:
+  /// Generates, compiles and loads the scorer of the given model, or loads
+  /// the one cached by a previous run.
+  ///
+  /// \param ranker The model to be compiled.
+  /// \param generator The code generator, either CONDOP or OBLIVIOUS.
+  /// \return The scorer, or a null pointer if it cannot be compiled or
+  ///         loaded.
+  static std::shared_ptr<CompiledScorer> create(
+      const learning::LTR_Algorithm &ranker, const std::string &generator);
+
+  /// Avoid copies of the loaded shared object
+  CompiledScorer(const CompiledScorer &other) = delete;
+  /// Avoid copies of the loaded shared object
+  CompiledScorer &operator=(const CompiledScorer &) = delete;
+
+  virtual ~CompiledScorer();
+
+  /// Returns the name of the scoring engine.
+  virtual std::string name() const {
+    return PREFIX_ + generator_;
+  }
+
+  /// The prefix of the names of the compiled scorers.
+  static const std::string PREFIX_;
+
+  virtual Score score_document(const Feature *d) const {
+    return ranker_(const_cast<Feature *>(d));
+  }
+
+  /// Returns the path of the loaded shared object.
+  const std::string &plugin_path() const {
+    return plugin_path_;
+  }
+
+ private:
+  std::string generator_;
+  std::string plugin_path_;
+  void *handle_ = nullptr;
+  double (*ranker_)(float *) = nullptr;
+
+  explicit CompiledScorer(const std::string &generator);
+
+  /// Generates, compiles and loads the scorer of the given model, returning
+  /// false if any step fails.
+  bool load(const learning::LTR_Algorithm &ranker);
+
+  /// Generates the source code of the model in \a tmp_basename.xml and
+  /// compiles it into the shared object \a plugin_path_, returning false if
+  /// compilation fails.
+  bool compile(const std::string &tmp_basename);
+};
+
+}  // namespace scoring
+}  // namespace quickrank
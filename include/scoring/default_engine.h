@@ -0,0 +1,69 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#pragma once
+
+#include <memory>
+
+#include "learning/ltr_algorithm.h"
+#include "scoring/scoring_engine.h"
+
+namespace quickrank {
+namespace scoring {
+
+/**
+ * This engine scores documents through the \a score_document and
+ * \a score_batch functions of the model itself, e.g., by walking the trees of
+ * an ensemble node by node. It is the reference for the other scoring
+ * engines.
+ */
+class DefaultEngine: public ScoringEngine {
+ public:
+  /// Creates a new engine scoring documents with the given model.
+  ///
+  /// \param ranker The model used for scoring.
+  explicit DefaultEngine(std::shared_ptr<const learning::LTR_Algorithm> ranker)
+      : ranker_(ranker) {
+  }
+
+  /// Returns the name of the scoring engine.
+  virtual std::string name() const {
+    return NAME_;
+  }
+
+  static const std::string NAME_;
+
+  virtual Score score_document(const Feature *d) const {
+    return ranker_->score_document(d);
+  }
+
+  virtual void score_documents(const Feature *d, size_t num_documents,
+                               size_t stride, Score *scores) const {
+    ranker_->score_batch(d, num_documents, stride,
+                         learning::Layout::ROW_MAJOR, scores);
+  }
+
+ private:
+  std::shared_ptr<const learning::LTR_Algorithm> ranker_;
+};
+
+}  // namespace scoring
+}  // namespace quickrank
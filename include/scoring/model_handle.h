@@ -0,0 +1,104 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "scoring/scoring_engine.h"
+
+namespace quickrank {
+namespace scoring {
+
+/**
+ * This class holds the scoring engine of the current model, which can be
+ * replaced while documents are being scored, in the style of read-copy-update.
+ *
+ * Scoring threads take a snapshot of the current engine with \a get and use it
+ * for a whole batch of documents, so that they never see a partially loaded
+ * model and they never wait for a new one to be loaded. A new engine is built
+ * aside, possibly in a background thread with \a reload, and it is published
+ * atomically: the previous one is destroyed by whichever thread releases its
+ * last snapshot, so publishing never waits for the batches still scoring it.
+ */
+class ModelHandle {
+ public:
+  /// Builds the scoring engine of a model, or returns a null pointer.
+  typedef std::function<std::shared_ptr<ScoringEngine>()> Loader;
+
+  /// Creates a new handle publishing the given engine. The caller should
+  /// not keep its own reference, which would keep the engine alive after a
+  /// new one is published.
+  explicit ModelHandle(std::shared_ptr<ScoringEngine> engine);
+
+  /// Avoid copies of the background loading thread
+  ModelHandle(const ModelHandle &other) = delete;
+  /// Avoid copies of the background loading thread
+  ModelHandle &operator=(const ModelHandle &) = delete;
+
+  /// Waits for the completion of the pending reload.
+  ~ModelHandle();
+
+  /// Returns the current engine, which stays valid as long as the returned
+  /// pointer is held, even if a new engine is published meanwhile.
+  std::shared_ptr<ScoringEngine> get() const;
+
+  /// Returns the number of engines published after the first one.
+  size_t version() const;
+
+  /// Publishes a new engine. The previous one is destroyed as soon as it is
+  /// no longer used, either here or by the last thread holding a snapshot.
+  void publish(std::shared_ptr<ScoringEngine> engine);
+
+  /// Builds a new engine by means of \a loader in a background thread and
+  /// publishes it, unless a null pointer is returned. Reloads are performed
+  /// one at a time, a reload waits for the completion of the previous one.
+  void reload(Loader loader);
+
+  /// Loads the model stored in the given file and builds the given engine in
+  /// a background thread, see \a reload and \a scoring_engine_factory.
+  /// The current model is kept if the file is missing or not valid, if the
+  /// engine does not support the model, or if the model needs more than
+  /// \a num_features features.
+  void reload(const std::string &model_file, const std::string &engine,
+              size_t num_features, size_t trees_block_size = 0,
+              size_t documents_block_size = 0);
+
+  /// Waits for the completion of the pending reload, if any, and returns
+  /// false if the last reload failed.
+  bool wait();
+
+ private:
+  std::shared_ptr<ScoringEngine> engine_;
+  std::atomic<size_t> version_;
+
+  std::mutex reload_mutex_;
+  std::thread loader_;
+  bool failed_ = false;
+};
+
+}  // namespace scoring
+}  // namespace quickrank
@@ -0,0 +1,98 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "learning/tree/ensemble.h"
+#include "scoring/scoring_engine.h"
+
+namespace quickrank {
+namespace scoring {
+
+/**
+ * This engine scores documents with an ensemble of oblivious regression
+ * trees, such as the ones learnt by ObliviousMart and ObliviousLambdaMart.
+ *
+ * All the nodes at the same level of an oblivious tree test the same feature
+ * against the same threshold, so that a tree of depth d is stored as d
+ * (feature, threshold) pairs and \f$ 2^d \f$ leaves. The index of the exit
+ * leaf is the bitmask of the d test outcomes, with the outcome of the root as
+ * the most significant bit, and it is computed without any branch. Several
+ * documents are processed at once with the same sequence of tests, so that
+ * the compiler can vectorize the computation of their leaf indexes.
+ */
+class ObliviousEngine: public ScoringEngine {
+ public:
+  /// Creates a new engine from the given ensemble.
+  /// The engine does not refer to \a ensemble after construction.
+  ///
+  /// \param ensemble The ensemble of oblivious regression trees.
+  /// \note Trees are limited to depth \a MAX_DEPTH, see \a supports.
+  explicit ObliviousEngine(const Ensemble &ensemble);
+
+  /// Returns true if all the trees of the given ensemble are oblivious, with
+  /// depth at most \a MAX_DEPTH.
+  static bool supports(const Ensemble &ensemble);
+
+  virtual ~ObliviousEngine() {
+  }
+
+  /// Returns the name of the scoring engine.
+  virtual std::string name() const {
+    return NAME_;
+  }
+
+  static const std::string NAME_;
+
+  /// The maximum depth of a tree.
+  static const size_t MAX_DEPTH = 20;
+
+  /// The number of documents processed at once.
+  static const size_t DOCUMENTS_AT_ONCE = 16;
+
+  virtual Score score_document(const Feature *d) const;
+
+  virtual void score_documents(const Feature *d, size_t num_documents,
+                               size_t stride, Score *scores) const;
+
+ private:
+  struct oblivious_tree {
+    size_t depth;
+    size_t first_level;
+    size_t first_leaf;
+  };
+
+  std::vector<oblivious_tree> trees_;
+  std::vector<uint32_t> features_;
+  std::vector<Feature> thresholds_;
+  std::vector<double> leaves_;
+  std::vector<double> weights_;
+
+  /// Scores up to \a DOCUMENTS_AT_ONCE documents.
+  void score_block(const Feature *d, size_t num_documents, size_t stride,
+                   Score *scores) const;
+};
+
+}  // namespace scoring
+}  // namespace quickrank
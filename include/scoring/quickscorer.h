@@ -0,0 +1,101 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "learning/tree/ensemble.h"
+#include "scoring/scoring_engine.h"
+
+namespace quickrank {
+namespace scoring {
+
+/**
+ * This engine implements the QuickScorer algorithm for scoring documents
+ * with an ensemble of regression trees.
+ *
+ * The leaves of each tree are numbered from left to right and the nodes of
+ * all the trees are grouped by feature and sorted by threshold. Each node
+ * stores the bitvector of the leaves still reachable when its test is false,
+ * i.e., when the document goes to the right child. Scoring a document visits
+ * the nodes of each feature in increasing order of threshold, up to the first
+ * true test, and-ing their bitvectors into the bitvector of their tree.
+ * The exit leaf of each tree is then the lowest bit set.
+ *
+ * See: C. Lucchese, F. M. Nardini, S. Orlando, R. Perego, N. Tonellotto,
+ * and R. Venturini. QuickScorer: a fast algorithm to rank documents with
+ * additive ensembles of regression trees. SIGIR 2015.
+ */
+class QuickScorer: public ScoringEngine {
+ public:
+  /// Creates a new engine from the given ensemble.
+  /// The engine does not refer to \a ensemble after construction.
+  ///
+  /// \param ensemble The ensemble of regression trees.
+  /// \param first_tree The first tree of \a ensemble to be used.
+  /// \param last_tree The tree following the last one to be used.
+  /// \note Trees are limited to \a MAX_LEAVES leaves, see \a supports.
+  explicit QuickScorer(const Ensemble &ensemble, size_t first_tree = 0,
+                       size_t last_tree = SIZE_MAX);
+
+  /// Returns true if all the trees of the given ensemble have at most
+  /// \a MAX_LEAVES leaves, as required by this engine and the derived ones.
+  static bool supports(const Ensemble &ensemble);
+
+  virtual ~QuickScorer() {
+  }
+
+  /// Returns the name of the scoring engine.
+  virtual std::string name() const {
+    return NAME_;
+  }
+
+  static const std::string NAME_;
+
+  /// The maximum number of leaves of a tree.
+  static const size_t MAX_LEAVES = 64;
+
+  virtual Score score_document(const Feature *d) const;
+
+ protected:
+  typedef uint64_t BitVector;
+
+  size_t num_trees_ = 0;
+
+  /// Ids of the features used by the ensemble.
+  std::vector<size_t> features_;
+  /// The nodes testing features_[i] are in [feature_offsets_[i],
+  /// feature_offsets_[i+1]), sorted by threshold.
+  std::vector<size_t> feature_offsets_;
+  std::vector<Feature> thresholds_;
+  std::vector<uint32_t> tree_ids_;
+  std::vector<BitVector> masks_;
+
+  /// The leaves of the i-th tree start at leaf_offsets_[i].
+  std::vector<size_t> leaf_offsets_;
+  std::vector<double> leaf_values_;
+  std::vector<double> weights_;
+};
+
+}  // namespace scoring
+}  // namespace quickrank
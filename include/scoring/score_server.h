@@ -0,0 +1,164 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#pragma once
+
+#include <stdint.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "scoring/model_handle.h"
+#include "scoring/scoring_engine.h"
+#include "types.h"
+
+namespace quickrank {
+namespace scoring {
+
+/**
+ * This class scores the batches of documents sent by clients over a stream,
+ * i.e., the standard input and output or the connections to a Unix domain
+ * socket, so that a model is loaded once and used by many requests.
+ *
+ * Requests and responses are sequences of 32-bit unsigned words, except for
+ * features and scores, all of them in the byte order of the machine:
+ * \verbatim
+   <request>  .=. <num documents> <num features> <top k> <features>
+   <features> .=. <num documents> x <num features> floats, by document
+   <response> .=. <status> <num results> <results>
+   <results>  .=. <num results> doubles, i.e., the scores, if <top k> is 0,
+                  or the indices of the top <num results> documents
+                  by decreasing score, otherwise
+   \endverbatim
+ * Usually, a request holds the candidate documents of one query. Documents
+ * with fewer features than the model are padded with zeros, as missing
+ * features in SVML files. Requests with more features than the model, or
+ * larger than MAX_DOCUMENTS x MAX_FEATURES, get a STATUS_BAD_REQUEST response
+ * with no results and the connection is closed.
+ *
+ * Each request is scored by the engine published by the ModelHandle of the
+ * server when the request is received, so that models can be replaced while
+ * requests are served.
+ */
+class ScoreServer {
+ public:
+  /// Creates a new server.
+  ///
+  /// \param engine The scoring engine of the model.
+  /// \param num_features The number of features of the documents of the model.
+  ScoreServer(std::shared_ptr<ScoringEngine> engine, size_t num_features);
+
+  /// Creates a new server scoring the models published by a handle.
+  ///
+  /// \param model The handle of the model.
+  /// \param num_features The number of features of the documents of the model.
+  ScoreServer(std::shared_ptr<ModelHandle> model, size_t num_features);
+
+  /// Returns the handle of the model.
+  std::shared_ptr<ModelHandle> model() const {
+    return model_;
+  }
+
+  /// Serves the requests read from \a in_fd and writes the responses to
+  /// \a out_fd, until end of file. Returns false if the stream was closed
+  /// because of an error.
+  bool serve_stream(int in_fd, int out_fd);
+
+  /// Serves the connections to the Unix domain socket at \a path with a pool
+  /// of \a num_threads threads, each of them serving one connection at a
+  /// time. The server stops accepting connections on SIGINT or SIGTERM, and
+  /// returns when the open ones are closed.
+  void serve_socket(const std::string &path, size_t num_threads);
+
+  /// Returns the number of requests served so far.
+  size_t num_requests() const;
+
+  /// Returns the number of documents scored so far.
+  size_t num_documents() const;
+
+  /// Returns the latencies of the requests served so far, in seconds, from
+  /// the end of the request to the end of the response.
+  std::vector<double> latencies() const;
+
+  static const uint32_t STATUS_OK = 0;
+  static const uint32_t STATUS_BAD_REQUEST = 1;
+
+  static const size_t MAX_DOCUMENTS = 1 << 20;
+  static const size_t MAX_FEATURES = 1 << 16;
+
+ private:
+  std::shared_ptr<ModelHandle> model_;
+  size_t num_features_;
+
+  mutable std::mutex stats_mutex_;
+  size_t num_documents_ = 0;
+  std::vector<double> latencies_;
+};
+
+/**
+ * This class sends requests to a ScoreServer and reads its responses, e.g.,
+ * to generate load when benchmarking a model.
+ */
+class ScoreClient {
+ public:
+  /// Connects to the server listening on the Unix domain socket at \a path.
+  explicit ScoreClient(const std::string &path);
+
+  /// Talks to a server over the given stream, which is closed by the client.
+  ScoreClient(int in_fd, int out_fd);
+
+  /// Avoid copies closing the same stream twice
+  ScoreClient(const ScoreClient &other) = delete;
+  /// Avoid copies closing the same stream twice
+  ScoreClient &operator=(const ScoreClient &) = delete;
+
+  ~ScoreClient();
+
+  /// Returns false if the connection failed.
+  bool is_connected() const {
+    return in_fd_ >= 0;
+  }
+
+  /// Sends a request and waits for its response.
+  ///
+  /// \param d The first document, stored feature by feature.
+  /// \param num_documents The number of documents.
+  /// \param num_features The number of features of each document.
+  /// \param top_k The number of top ranked documents returned (0 means
+  /// returning the scores of all the documents).
+  /// \param scores The vector where scores are stored when \a top_k is 0.
+  /// \param top The vector where the indices of the top ranked documents are
+  /// stored when \a top_k is not 0.
+  /// \return The status of the response, or STATUS_BAD_REQUEST if the
+  /// connection was broken.
+  uint32_t score(const Feature *d, size_t num_documents, size_t num_features,
+                 size_t top_k, std::vector<Score> &scores,
+                 std::vector<uint32_t> &top);
+
+ private:
+  int in_fd_;
+  int out_fd_;
+};
+
+}  // namespace scoring
+}  // namespace quickrank
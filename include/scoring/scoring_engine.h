@@ -0,0 +1,94 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#pragma once
+
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "data/dataset.h"
+#include "types.h"
+
+namespace quickrank {
+namespace scoring {
+
+/**
+ * This is the base class of the in-process scoring engines.
+ *
+ * A scoring engine is built from a trained or loaded model and it computes
+ * the same scores of the model with a data layout and a traversal strategy
+ * suited to fast inference.
+ */
+class ScoringEngine {
+ public:
+  ScoringEngine() {
+  }
+
+  /// Avoid inefficient copy constructor
+  ScoringEngine(const ScoringEngine &other) = delete;
+  /// Avoid inefficient copy assignment
+  ScoringEngine &operator=(const ScoringEngine &) = delete;
+
+  virtual ~ScoringEngine() {
+  }
+
+  /// Returns the name of the scoring engine.
+  virtual std::string name() const = 0;
+
+  /// Returns the score of a given document.
+  ///
+  /// \param d Document to be scored, stored feature by feature.
+  virtual Score score_document(const Feature *d) const = 0;
+
+  /// Scores a sequence of documents and stores the results in the \a scores
+  /// vector. Engines scoring several documents at once override this
+  /// function, the default one scores documents one by one.
+  ///
+  /// \param d The first document to be scored, stored feature by feature.
+  /// \param num_documents The number of documents to be scored.
+  /// \param stride The distance between two consecutive documents.
+  /// \param scores The vector where scores are stored.
+  virtual void score_documents(const Feature *d, size_t num_documents,
+                               size_t stride, Score *scores) const;
+
+  /// Scores all the documents of a given dataset and stores the results
+  /// in the \a scores vector. Blocks of \a DOCUMENTS_BLOCK_SIZE documents
+  /// are scored in parallel.
+  ///
+  /// \param dataset The dataset to be scored.
+  /// \param scores The vector where scores are stored.
+  virtual void score_dataset(std::shared_ptr<data::Dataset> dataset,
+                             Score *scores) const;
+
+  /// Number of documents scored by each call to \a score_documents
+  /// when scoring a dataset.
+  static const size_t DOCUMENTS_BLOCK_SIZE = 64;
+
+ private:
+  /// The output stream operator.
+  friend std::ostream &operator<<(std::ostream &os, const ScoringEngine &e) {
+    return os << e.name();
+  }
+};
+
+}  // namespace scoring
+}  // namespace quickrank
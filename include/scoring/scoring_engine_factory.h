@@ -0,0 +1,52 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "learning/ltr_algorithm.h"
+#include "scoring/scoring_engine.h"
+
+namespace quickrank {
+namespace scoring {
+
+/// Names of the scoring engines created by \a scoring_engine_factory.
+extern const std::vector<std::string> scoringEngineNames;
+
+/// Creates a scoring engine for a trained or loaded model.
+///
+/// \param engine The name of the scoring engine.
+/// \param ranker The model to be used for scoring.
+/// \param trees_block_size The number of trees in each block of block-wise
+///        engines. If 0, it is chosen according to the cache sizes.
+/// \param documents_block_size The number of documents in each batch of
+///        block-wise engines. If 0, it is chosen according to the cache sizes.
+/// \return The scoring engine, or a null pointer if the engine is unknown
+///         or it does not support the given model.
+std::shared_ptr<ScoringEngine> scoring_engine_factory(
+    std::string engine, std::shared_ptr<learning::LTR_Algorithm> ranker,
+    size_t trees_block_size = 0, size_t documents_block_size = 0);
+
+}  // namespace scoring
+}  // namespace quickrank
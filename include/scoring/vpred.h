@@ -0,0 +1,105 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "learning/tree/ensemble.h"
+#include "scoring/scoring_engine.h"
+
+namespace quickrank {
+namespace scoring {
+
+/**
+ * This engine implements the VPred algorithm for scoring documents with an
+ * ensemble of regression trees.
+ *
+ * Each tree is stored as a complete binary tree as deep as the original one,
+ * with the nodes in breadth-first order, so that the children of node i are
+ * nodes 2i+1 and 2i+2. Leaves shallower than the tree are pushed down to the
+ * last level. A tree is traversed by predication, with exactly depth steps of
+ * \f$ i = 2i + 1 + (x_{f_i} > t_i) \f$, and several documents are traversed
+ * at once to overlap their memory accesses.
+ *
+ * See: N. Asadi, J. Lin, and A. P. de Vries. Runtime optimizations for
+ * tree-based machine learning models. IEEE TKDE, 2014.
+ */
+class VPred: public ScoringEngine {
+ public:
+  /// Creates a new engine from the given ensemble.
+  /// The engine does not refer to \a ensemble after construction.
+  ///
+  /// \param ensemble The ensemble of regression trees.
+  /// \note Trees are limited to depth \a MAX_DEPTH, see \a supports.
+  explicit VPred(const Ensemble &ensemble);
+
+  /// Returns true if all the trees of the given ensemble have depth at most
+  /// \a MAX_DEPTH.
+  static bool supports(const Ensemble &ensemble);
+
+  virtual ~VPred() {
+  }
+
+  /// Returns the name of the scoring engine.
+  virtual std::string name() const {
+    return NAME_;
+  }
+
+  static const std::string NAME_;
+
+  /// The maximum depth of a tree.
+  static const size_t MAX_DEPTH = 16;
+
+  /// The number of documents traversed at once.
+  static const size_t DOCUMENTS_AT_ONCE = 8;
+
+  virtual Score score_document(const Feature *d) const;
+
+  virtual void score_documents(const Feature *d, size_t num_documents,
+                               size_t stride, Score *scores) const;
+
+ private:
+  struct complete_tree {
+    size_t depth;
+    size_t first_node;
+    size_t first_leaf;
+  };
+
+  std::vector<complete_tree> trees_;
+  std::vector<uint32_t> features_;
+  std::vector<Feature> thresholds_;
+  std::vector<double> leaves_;
+  std::vector<double> weights_;
+
+  /// Stores the subtree rooted in \a node at position \a pos of the complete
+  /// tree \a tree.
+  void fill(const complete_tree &tree, const RTNode *node, size_t pos,
+            size_t level);
+
+  /// Scores up to \a DOCUMENTS_AT_ONCE documents.
+  void score_block(const Feature *d, size_t num_documents, size_t stride,
+                   Score *scores) const;
+};
+
+}  // namespace scoring
+}  // namespace quickrank
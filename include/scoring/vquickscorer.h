@@ -0,0 +1,122 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "scoring/quickscorer.h"
+
+namespace quickrank {
+namespace scoring {
+
+/**
+ * This engine implements the vectorized QuickScorer algorithm, scoring a
+ * block of documents at once.
+ *
+ * The nodes of a feature are visited once for all the documents of the block:
+ * each threshold is compared against the feature values of 8 (AVX2) or 16
+ * (AVX-512) documents with a single instruction, and the bitvectors of the
+ * documents whose test is false are updated together. The instruction set
+ * is chosen at run time according to the CPU, with a portable fallback.
+ *
+ * See: C. Lucchese, F. M. Nardini, S. Orlando, R. Perego, N. Tonellotto,
+ * and R. Venturini. Exploiting CPU SIMD extensions to speed-up document
+ * scoring with tree ensembles. SIGIR 2016.
+ */
+class VQuickScorer: public QuickScorer {
+ public:
+  enum class InstructionSet {
+    SCALAR, AVX2, AVX512
+  };
+
+  /// Creates a new engine from the given ensemble.
+  ///
+  /// \param ensemble The ensemble of regression trees.
+  /// \param instruction_set The instruction set to be used. If not supported
+  ///        by the CPU, the best supported one is used instead.
+  /// \param first_tree The first tree of \a ensemble to be used.
+  /// \param last_tree The tree following the last one to be used.
+  explicit VQuickScorer(
+      const Ensemble &ensemble,
+      InstructionSet instruction_set = InstructionSet::AVX512,
+      size_t first_tree = 0, size_t last_tree = SIZE_MAX);
+
+  virtual ~VQuickScorer() {
+  }
+
+  /// Returns the name of the scoring engine.
+  virtual std::string name() const {
+    return NAME_;
+  }
+
+  static const std::string NAME_;
+
+  static const std::vector<std::string> instructionSetNames;
+
+  /// Returns the instruction set actually used.
+  InstructionSet instruction_set() const {
+    return instruction_set_;
+  }
+
+  virtual void score_documents(const Feature *d, size_t num_documents,
+                               size_t stride, Score *scores) const;
+
+  /// Adds the scores of a sequence of documents to the \a scores vector.
+  /// The contribution of each tree is added in order to the current score,
+  /// so that scoring consecutive blocks of trees gives the same result of
+  /// scoring the whole ensemble.
+  ///
+  /// \param d The first document to be scored, stored feature by feature.
+  /// \param num_documents The number of documents to be scored.
+  /// \param stride The distance between two consecutive documents.
+  /// \param scores The vector where scores are accumulated.
+  void accumulate_documents(const Feature *d, size_t num_documents,
+                            size_t stride, Score *scores) const;
+
+ private:
+  InstructionSet instruction_set_;
+
+  /// Returns the best instruction set supported by the CPU.
+  static InstructionSet supported_instruction_set();
+
+  /// Scores up to \a width documents, with \a width the number of documents
+  /// scored at once by the given instruction set. The bitvectors of the
+  /// documents are stored tree by tree in \a leafidx.
+  void score_block_scalar(const Feature *d, size_t num_documents,
+                          size_t stride, Score *scores,
+                          BitVector *leafidx) const;
+  void score_block_avx2(const Feature *d, size_t num_documents,
+                        size_t stride, Score *scores,
+                        BitVector *leafidx) const;
+  void score_block_avx512(const Feature *d, size_t num_documents,
+                          size_t stride, Score *scores,
+                          BitVector *leafidx) const;
+
+  /// Adds the leaves identified by the bitvectors of a block of \a width
+  /// documents to their scores, following the order of the trees.
+  void sum_leaves(const BitVector *leafidx, size_t width,
+                  size_t num_documents, Score *scores) const;
+};
+
+}  // namespace scoring
+}  // namespace quickrank
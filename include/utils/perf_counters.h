@@ -0,0 +1,96 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#pragma once
+
+#include <stdint.h>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * Hardware performance counters of the calling thread, read by means of the
+ * perf_event_open system call. Only user-space events are counted, so that
+ * no special privilege is needed. Counters that cannot be opened, e.g., in
+ * containers, in virtual machines or on other operating systems than Linux,
+ * are reported as unavailable and read as zero.
+ */
+class PerfCounters {
+ public:
+  /// The events counted.
+  enum class Event {
+    CYCLES, INSTRUCTIONS, BRANCH_MISSES, CACHE_MISSES
+  };
+
+  static const size_t NUM_EVENTS = 4;
+
+  /// The names of the events counted.
+  static const std::vector<std::string> eventNames;
+
+  /// Opens and starts the counters of the calling thread.
+  PerfCounters();
+
+  ~PerfCounters();
+
+  /// Avoid closing the counters twice
+  PerfCounters(const PerfCounters &other) = delete;
+  PerfCounters &operator=(const PerfCounters &) = delete;
+
+  /// Returns true if the given event is counted.
+  bool available(Event event) const {
+    return fds_[(size_t) event] >= 0;
+  }
+
+  /// Reads the current value of every counter.
+  void read(uint64_t values[NUM_EVENTS]) const;
+
+ private:
+  int fds_[NUM_EVENTS];
+};
+
+/**
+ * Measures the hardware performance counters of a named phase, from the
+ * construction to the destruction of the object. Events are summed over the
+ * threads of the OpenMP team, and they are accumulated over all the
+ * executions of the phase.
+ *
+ * Phases are instrumented with the \a QUICKRANK_PERF_PHASE macro, which
+ * expands to nothing unless QUICKRANK_PERF_COUNTERS is defined.
+ */
+class PerfPhase {
+ public:
+  explicit PerfPhase(const std::string &name);
+
+  ~PerfPhase();
+
+  /// Prints the events of each phase, averaged over its executions.
+  static void report(std::ostream &os);
+
+ private:
+  std::string name_;
+  uint64_t start_[PerfCounters::NUM_EVENTS];
+};
+
+#ifdef QUICKRANK_PERF_COUNTERS
+#define QUICKRANK_PERF_PHASE(name) PerfPhase perf_phase_(name)
+#else
+#define QUICKRANK_PERF_PHASE(name)
+#endif
@@ -95,6 +95,11 @@ std::unique_ptr<QueryResults> Dataset::getQueryResults(size_t i) const {
   return std::unique_ptr<QueryResults>(qr);
 }
 
+QueryResults Dataset::getQueryResultsView(size_t i) const {
+  return QueryResults(offsets_[i + 1] - offsets_[i], labels_ + offsets_[i],
+                      data_ + offsets_[i] * num_features_);
+}
+
 std::ostream &Dataset::put(std::ostream &os) const {
   os << "#\t Dataset size: " << num_instances_ << " x " << num_features_
      << " (instances x features)" << std::endl << "#\t Num queries: "
@@ -19,6 +19,8 @@
  * Contributor:
  *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
  */
+#include <vector>
+
 #include "data/queryresults.h"
 
 namespace quickrank {
@@ -39,26 +41,42 @@ struct external_sort_op_t {
   external_sort_op_t(const Score *values) {
     values_ = values;
   }
-  bool operator()(int i, int j) {
+  bool operator()(size_t i, size_t j) const {
     return (values_[i] > values_[j]);
   }
 };
 
 void QueryResults::indexing_of_sorted_labels(const Score *scores,
-                                             size_t *dest) const {
+                                             size_t *dest,
+                                             const size_t cutoff) const {
   external_sort_op_t comp(scores);
   for (size_t i = 0; i < num_results_; ++i)
     dest[i] = i;
-  std::sort(dest, dest + num_results_, comp);
+  if (cutoff < num_results_) {
+    // select the top-cutoff elements and sort only those
+    std::nth_element(dest, dest + cutoff, dest + num_results_, comp);
+    std::sort(dest, dest + cutoff, comp);
+    // documents tied with the last selected one are moved right after it
+    if (cutoff > 0) {
+      const Score last_score = scores[dest[cutoff - 1]];
+      size_t next = cutoff;
+      for (size_t j = cutoff; j < num_results_; ++j)
+        if (scores[dest[j]] == last_score)
+          std::swap(dest[next++], dest[j]);
+    }
+  } else {
+    std::sort(dest, dest + num_results_, comp);
+  }
 }
 
 void QueryResults::sorted_labels(const Score *scores, Label *dest,
                                  const size_t cutoff) const {
-  size_t *idx = new size_t[num_results_];
-  indexing_of_sorted_labels(scores, idx);
+  // the index buffer is per-thread and reused across calls
+  static thread_local std::vector<size_t> idx;
+  idx.resize(num_results_);
+  indexing_of_sorted_labels(scores, idx.data(), cutoff);
   for (size_t i = 0; i < num_results_ && i < cutoff; ++i)
     dest[i] = labels_[idx[i]];
-  delete[] idx;
 }
 
 }  // namespace data
@@ -87,6 +87,11 @@ std::unique_ptr<QueryResults> VerticalDataset::getQueryResults(size_t i) const {
   return std::unique_ptr<QueryResults>(qr);
 }
 
+QueryResults VerticalDataset::getQueryResultsView(size_t i) const {
+  return QueryResults(offsets_[i + 1] - offsets_[i], labels_ + offsets_[i],
+                      data_ + offsets_[i]);
+}
+
 
 std::ostream &VerticalDataset::put(std::ostream &os) const {
   os << "#\t Vertical Dataset size: " << num_instances_ << " x "
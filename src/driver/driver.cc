@@ -19,10 +19,12 @@
  * Contributor:
  *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
  */
+#include <cctype>
 #include <iomanip>
 #include <fstream>
 #include <limits>
 #include <numeric>
+#include <sstream>
 #include <io/generate_oblivious.h>
 #include <learning/meta/meta_cleaver.h>
 
@@ -31,7 +33,10 @@
 #include "learning/ltr_algorithm_factory.h"
 #include "optimization/optimization_factory.h"
 #include "metric/metric_factory.h"
+#include "metric/ir/evaluator.h"
+#include "scoring/scoring_engine_factory.h"
 #include "utils/fileutils.h"
+#include "utils/perf_counters.h"
 
 namespace quickrank {
 namespace driver {
@@ -44,14 +49,17 @@ Driver::~Driver() {
 
 int Driver::run(ParamsMap &pmap) {
 
+  const bool convert_model = pmap.isSet("model-in") && pmap.isSet("model-out")
+      && !pmap.isSet("train") && !pmap.isSet("train-partial");
+
   if (!pmap.isSet("train") && !pmap.isSet("train-partial") &&
-      !pmap.isSet("test") && !pmap.isSet("model-file")) {
+      !pmap.isSet("test") && !pmap.isSet("model-file") && !convert_model) {
     std::cout << pmap.help();
     exit(EXIT_FAILURE);
   }
 
   if (pmap.isSet("train") || pmap.isSet("train-partial") ||
-      pmap.isSet("test")) {
+      pmap.isSet("test") || convert_model) {
 
     std::shared_ptr<quickrank::learning::LTR_Algorithm> ranking_algorithm =
         quickrank::learning::ltr_algorithm_factory(pmap);
@@ -62,6 +70,22 @@ int Driver::run(ParamsMap &pmap) {
 
     std::cout << std::endl << *ranking_algorithm << std::endl;
 
+    std::string model_format = pmap.get<std::string>("model-format");
+    if (model_format == "binary")
+      ranking_algorithm->set_model_format(learning::ModelFormat::BINARY);
+    else if (model_format != "xml") {
+      std::cerr << " !! Model format was not set properly" << std::endl;
+      exit(EXIT_FAILURE);
+    }
+
+    // a model which is not trained again is saved in the requested format
+    if (convert_model) {
+      std::string model_filename_out = pmap.get<std::string>("model-out");
+      std::cout << "# Writing model to file: " << model_filename_out
+                << std::endl << std::endl;
+      ranking_algorithm->save(model_filename_out);
+    }
+
     // If there is the training dataset, it means we have to execute
     // the training phase and/or the optimization phase (at least one of them)
     if (pmap.isSet("train") || pmap.isSet("train-partial")) {
@@ -118,6 +142,10 @@ int Driver::run(ParamsMap &pmap) {
         exit(EXIT_FAILURE);
       }
 
+      if (pmap.isSet("valid-metrics"))
+        ranking_algorithm->set_validation_metrics(
+            parse_metrics(pmap.get<std::string>("valid-metrics")));
+
       if (opt_algorithm && opt_algorithm->is_pre_learning()) {
         // We have to run the optimization process pre-training
         optimization_phase(opt_algorithm,
@@ -184,13 +212,32 @@ int Driver::run(ParamsMap &pmap) {
         exit(EXIT_FAILURE);
       }
 
+      std::shared_ptr<quickrank::scoring::ScoringEngine> scoring_engine;
+      if (pmap.isSet("engine")) {
+        scoring_engine = quickrank::scoring::scoring_engine_factory(
+            pmap.get<std::string>("engine"), ranking_algorithm,
+            pmap.get<size_t>("trees-block-size"),
+            pmap.get<size_t>("docs-block-size"));
+        if (!scoring_engine) {
+          std::cerr << " !! Scoring Engine was not set properly" << std::endl;
+          exit(EXIT_FAILURE);
+        }
+        std::cout << "# scoring engine: " << *scoring_engine << std::endl;
+      }
+
+      std::vector<std::shared_ptr<quickrank::metric::ir::Metric>> test_metrics;
+      if (pmap.isSet("test-metrics"))
+        test_metrics = parse_metrics(pmap.get<std::string>("test-metrics"));
+
       std::cout << "# test scorer: " << *testing_metric << std::endl << "#" <<
                 std::endl;
       testing_phase(ranking_algorithm,
                     testing_metric,
                     test_dataset,
                     scores_filename,
-                    detailed_testing);
+                    detailed_testing,
+                    test_metrics,
+                    scoring_engine);
     }
   }
 
@@ -222,6 +269,10 @@ int Driver::run(ParamsMap &pmap) {
     }
   }
 
+#ifdef QUICKRANK_PERF_COUNTERS
+  PerfPhase::report(std::cout);
+#endif
+
   return EXIT_SUCCESS;
 }
 
@@ -233,6 +284,11 @@ void Driver::training_phase(
     const std::string output_filename,
     const size_t npartialsave) {
 
+  // precompute per-query metric data, e.g., ideal DCG
+  train_metric->prepare(training_dataset);
+  if (validation_dataset)
+    train_metric->prepare(validation_dataset);
+
   // run the learning process
   algo->learn(training_dataset, validation_dataset, train_metric, npartialsave,
               output_filename);
@@ -299,6 +355,19 @@ void Driver::optimization_phase(
     }
   }
 
+  // precompute per-query metric data on the datasets to be evaluated
+  if (need_ps) {
+    if (training_partial_dataset)
+      train_metric->prepare(training_partial_dataset);
+    if (validation_partial_dataset)
+      train_metric->prepare(validation_partial_dataset);
+  } else {
+    if (training_dataset)
+      train_metric->prepare(training_dataset);
+    if (validation_dataset)
+      train_metric->prepare(validation_dataset);
+  }
+
   // run the optimization process
   opt_algorithm->optimize(
       ranking_algo,
@@ -328,10 +397,17 @@ void Driver::testing_phase(
     std::shared_ptr<quickrank::metric::ir::Metric> test_metric,
     std::shared_ptr<quickrank::data::Dataset> test_dataset,
     const std::string scores_filename,
-    const bool detailed_testing) {
+    const bool detailed_testing,
+    std::vector<std::shared_ptr<quickrank::metric::ir::Metric>> test_metrics,
+    std::shared_ptr<quickrank::scoring::ScoringEngine> scoring_engine) {
 
   if (test_metric and test_dataset) {
 
+    // all the metrics share a single ranking of each test query
+    test_metrics.insert(test_metrics.begin(), test_metric);
+    quickrank::metric::ir::Evaluator evaluator(test_metrics);
+    evaluator.prepare(test_dataset);
+
     std::vector<Score> scores(test_dataset->num_instances(), 0.0);
     if (detailed_testing) {
       std::shared_ptr<data::Dataset> datasetPartScores =
@@ -347,11 +423,13 @@ void Driver::testing_phase(
         }
       }
 
-      quickrank::MetricScore test_score = test_metric->evaluate_dataset(
-          test_dataset, &scores[0]);
+      std::vector<quickrank::MetricScore> test_scores =
+          evaluator.evaluate_dataset(test_dataset, &scores[0]);
 
-      std::cout << *test_metric << " on test data = " << std::setprecision(4)
-                << test_score << std::endl << std::endl;
+      for (size_t m = 0; m < evaluator.num_metrics(); ++m)
+        std::cout << *evaluator.metric(m) << " on test data = "
+                  << std::setprecision(4) << test_scores[m] << std::endl;
+      std::cout << std::endl;
 
       quickrank::io::Svml svml;
       svml.write(datasetPartScores, scores_filename);
@@ -360,13 +438,18 @@ void Driver::testing_phase(
                 << std::endl;
 
     } else {
-      algo->score_dataset(test_dataset, &scores[0]);
-      quickrank::MetricScore test_score = test_metric->evaluate_dataset(
-          test_dataset, &scores[0]);
+      if (scoring_engine)
+        scoring_engine->score_dataset(test_dataset, &scores[0]);
+      else
+        algo->score_dataset(test_dataset, &scores[0]);
+      std::vector<quickrank::MetricScore> test_scores =
+          evaluator.evaluate_dataset(test_dataset, &scores[0]);
 
       std::cout << std::endl;
-      std::cout << *test_metric << " on test data = " << std::setprecision(4)
-                << test_score << std::endl << std::endl;
+      for (size_t m = 0; m < evaluator.num_metrics(); ++m)
+        std::cout << *evaluator.metric(m) << " on test data = "
+                  << std::setprecision(4) << test_scores[m] << std::endl;
+      std::cout << std::endl;
 
       if (!scores_filename.empty()) {
         std::ofstream os;
@@ -384,6 +467,42 @@ void Driver::testing_phase(
   algo->print_additional_stats();
 }
 
+std::vector<std::shared_ptr<quickrank::metric::ir::Metric>>
+Driver::parse_metrics(const std::string metrics_string) {
+  std::vector<std::shared_ptr<quickrank::metric::ir::Metric>> metrics;
+  std::stringstream ss(metrics_string);
+  std::string metric_string;
+  while (std::getline(ss, metric_string, ',')) {
+    if (metric_string.empty())
+      continue;
+    // the cutoff follows the metric name, e.g., NDCG@10
+    std::string name = metric_string;
+    size_t cutoff = quickrank::metric::ir::Metric::NO_CUTOFF;
+    size_t at = metric_string.find('@');
+    if (at != std::string::npos) {
+      name = metric_string.substr(0, at);
+      const char *cutoff_string = metric_string.c_str() + at + 1;
+      char *end = NULL;
+      cutoff = std::strtoul(cutoff_string, &end, 10);
+      if (!std::isdigit(static_cast<unsigned char>(*cutoff_string))
+          || *end != '\0') {
+        std::cerr << "!!! Invalid cutoff in metric " << metric_string
+                  << std::endl;
+        exit(EXIT_FAILURE);
+      }
+    }
+    std::shared_ptr<quickrank::metric::ir::Metric> metric =
+        quickrank::metric::ir::ir_metric_factory(name, cutoff);
+    if (!metric) {
+      std::cerr << " !! Metric " << metric_string << " was not set properly"
+                << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    metrics.push_back(metric);
+  }
+  return metrics;
+}
+
 std::shared_ptr<quickrank::data::Dataset> Driver::load_dataset(
     const std::string dataset_filename,
     const std::string dataset_label) {
@@ -0,0 +1,182 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "io/binary_model.h"
+
+namespace quickrank {
+namespace io {
+
+const char BinaryModel::MAGIC[8] = "QRMODEL";
+
+namespace {
+
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+struct header {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint64_t info_size;
+};
+
+bool invalid_model(const std::string &filename) {
+  std::cerr << "!!! Model " + filename + " is not a valid binary model."
+            << std::endl;
+  return false;
+}
+
+/// Reads a string preceded by its length, returning false if \a data is too
+/// short.
+bool read_string(const char *&data, const char *end, std::string &s) {
+  uint32_t length;
+  if ((size_t) (end - data) < sizeof(length))
+    return false;
+  memcpy(&length, data, sizeof(length));
+  data += sizeof(length);
+  if ((size_t) (end - data) < length)
+    return false;
+  s.assign(data, length);
+  data += length;
+  return true;
+}
+
+void write_string(std::ostream &os, const std::string &s) {
+  const uint32_t length = s.size();
+  os.write(reinterpret_cast<const char *>(&length), sizeof(length));
+  os.write(s.data(), length);
+}
+
+}  // namespace
+
+BinaryModel::BinaryModel(const std::string &filename) {
+  if (!map(filename))
+    exit(EXIT_FAILURE);
+}
+
+std::shared_ptr<BinaryModel> BinaryModel::open(const std::string &filename) {
+  std::shared_ptr<BinaryModel> binary_model(new BinaryModel());
+  if (!binary_model->map(filename))
+    return nullptr;
+  return binary_model;
+}
+
+bool BinaryModel::map(const std::string &filename) {
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) != 0) {
+    if (fd >= 0)
+      close(fd);
+    std::cerr << "!!! Model " + filename + " cannot be opened." << std::endl;
+    return false;
+  }
+  mapping_size_ = st.st_size;
+  if (mapping_size_ < sizeof(header)) {
+    close(fd);
+    return invalid_model(filename);
+  }
+  // pages are shared with the other processes mapping the same model
+  mapping_ = mmap(NULL, mapping_size_, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapping_ == MAP_FAILED) {
+    mapping_ = nullptr;
+    std::cerr << "!!! Model " + filename + " cannot be mapped." << std::endl;
+    return false;
+  }
+
+  const char *begin = static_cast<const char *>(mapping_);
+  const char *end = begin + mapping_size_;
+  header h;
+  memcpy(&h, begin, sizeof(h));
+  if (memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0)
+    return invalid_model(filename);
+  if (h.byte_order != BYTE_ORDER_MARK) {
+    std::cerr << "!!! Model " + filename + " was written on a machine with "
+        "a different byte order." << std::endl;
+    return false;
+  }
+  if (h.version != VERSION) {
+    std::cerr << "!!! Model " + filename + " has version " << h.version
+              << ", while version " << VERSION << " is supported."
+              << std::endl;
+    return false;
+  }
+
+  const char *data = begin + sizeof(header);
+  for (uint64_t i = 0; i < h.info_size; ++i) {
+    std::string key, value;
+    if (!read_string(data, end, key) || !read_string(data, end, value))
+      return invalid_model(filename);
+    info_.emplace_back(key, value);
+  }
+  const size_t offset = (data - begin + 7) / 8 * 8;
+  if (offset > mapping_size_)
+    return invalid_model(filename);
+  data_ = begin + offset;
+  data_size_ = mapping_size_ - offset;
+  return true;
+}
+
+BinaryModel::~BinaryModel() {
+  if (mapping_)
+    munmap(mapping_, mapping_size_);
+}
+
+bool BinaryModel::is_binary_model(const std::string &filename) {
+  char magic[sizeof(MAGIC)];
+  std::ifstream is(filename, std::ios::binary);
+  return is.read(magic, sizeof(magic))
+      && memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+void BinaryModel::write_header(
+    std::ostream &os,
+    const std::vector<std::pair<std::string, std::string>> &info) {
+  header h;
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, MAGIC, sizeof(MAGIC));
+  h.version = VERSION;
+  h.byte_order = BYTE_ORDER_MARK;
+  h.info_size = info.size();
+  os.write(reinterpret_cast<const char *>(&h), sizeof(h));
+
+  size_t size = sizeof(h);
+  for (const auto &pair: info) {
+    write_string(os, pair.first);
+    write_string(os, pair.second);
+    size += 2 * sizeof(uint32_t) + pair.first.size() + pair.second.size();
+  }
+  // the data of the model is aligned to 8 bytes
+  const char padding[8] = {0};
+  if (size % 8)
+    os.write(padding, 8 - size % 8);
+}
+
+}  // namespace io
+}  // namespace quickrank
@@ -0,0 +1,164 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include <cstdio>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+
+#include "io/checkpoint_log.h"
+
+namespace quickrank {
+namespace io {
+
+const std::string CheckpointLog::MAGIC = "<!-- QuickRank checkpoint log -->\n";
+
+namespace {
+
+/// Ends every record of the log, so that a truncated one can be detected.
+const std::string END_OF_RECORD = "<!-- end of checkpoint -->\n";
+
+void write_error(const std::string &filename) {
+  std::cerr << "!!! Checkpoint log " + filename + " cannot be written."
+            << std::endl;
+  exit(EXIT_FAILURE);
+}
+
+}  // namespace
+
+CheckpointLog::CheckpointLog(const std::string &filename,
+                             const pugi::xml_document &model)
+    : filename_(filename) {
+  // the log is replaced atomically, as training may restart from it
+  const std::string tmp_filename = filename + ".tmp";
+  {
+    std::ofstream os(tmp_filename);
+    os << MAGIC;
+    pugi::xml_node ranker = model.child("ranker");
+    ranker.child("info").print(os, "\t");
+    os << END_OF_RECORD;
+
+    pugi::xml_document first;
+    pugi::xml_node checkpoint = first.append_child("checkpoint");
+    for (const auto &tree: ranker.child("ensemble").children("tree")) {
+      checkpoint.append_copy(tree);
+      ++num_trees_;
+    }
+    checkpoint.print(os, "\t");
+    os << END_OF_RECORD;
+    if (!os)
+      write_error(tmp_filename);
+  }
+  if (std::rename(tmp_filename.c_str(), filename.c_str()) != 0)
+    write_error(filename);
+
+  os_.open(filename, std::ofstream::app);
+  if (!os_)
+    write_error(filename);
+  writer_ = std::thread(&CheckpointLog::write_checkpoints, this);
+}
+
+CheckpointLog::~CheckpointLog() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closing_ = true;
+  }
+  cond_.notify_one();
+  writer_.join();
+}
+
+void CheckpointLog::append(
+    std::vector<std::pair<const RTNode *, double>> trees) {
+  checkpoint c;
+  c.first_id = num_trees_ + 1;
+  c.trees = std::move(trees);
+  num_trees_ += c.trees.size();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.push_back(std::move(c));
+  }
+  cond_.notify_one();
+}
+
+void CheckpointLog::write_checkpoints() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cond_.wait(lock, [this] { return closing_ || !pending_.empty(); });
+    if (pending_.empty())
+      return;
+    checkpoint c = std::move(pending_.front());
+    pending_.pop_front();
+    lock.unlock();
+
+    pugi::xml_document doc;
+    pugi::xml_node checkpoint = doc.append_child("checkpoint");
+    for (size_t i = 0; i < c.trees.size(); ++i) {
+      pugi::xml_node tree = checkpoint.append_child("tree");
+      tree.append_attribute("id") = c.first_id + i;
+      tree.append_attribute("weight") = c.trees[i].second;
+      c.trees[i].first->append_xml_model(tree);
+    }
+    // a record is written at once, to keep a crash from truncating it
+    std::stringstream record;
+    checkpoint.print(record, "\t");
+    record << END_OF_RECORD;
+    os_ << record.str();
+    os_.flush();
+    if (!os_)
+      write_error(filename_);
+
+    lock.lock();
+  }
+}
+
+bool CheckpointLog::is_checkpoint_log(const std::string &filename) {
+  std::string magic(MAGIC.size(), '\0');
+  std::ifstream is(filename, std::ios::binary);
+  return is.read(&magic[0], magic.size()) && magic == MAGIC;
+}
+
+bool CheckpointLog::read(const std::string &filename,
+                         pugi::xml_document &model) {
+  std::ifstream is(filename, std::ios::binary);
+  std::string log((std::istreambuf_iterator<char>(is)),
+                  std::istreambuf_iterator<char>());
+
+  // a last record truncated by a crash is ignored
+  const size_t end = log.rfind(END_OF_RECORD);
+  if (log.compare(0, MAGIC.size(), MAGIC) != 0 || end == std::string::npos)
+    return false;
+
+  pugi::xml_document records;
+  if (!records.load_buffer(log.data(), end + END_OF_RECORD.size(),
+                           pugi::parse_default | pugi::parse_fragment))
+    return false;
+
+  pugi::xml_node ranker = model.append_child("ranker");
+  ranker.append_copy(records.child("info"));
+  pugi::xml_node ensemble = ranker.append_child("ensemble");
+  for (const auto &checkpoint: records.children("checkpoint"))
+    for (const auto &tree: checkpoint.children("tree"))
+      ensemble.append_copy(tree);
+  return true;
+}
+
+}  // namespace io
+}  // namespace quickrank
@@ -46,7 +46,7 @@ void model_node_to_conditional_operators(pugi::xml_node &nodes,
       threshold = node.text().as_string();
       trim(threshold);
       // dealing with integer values
-      if (threshold.find(".") == std::string::npos)
+      if (threshold.find_first_of(".eEn") == std::string::npos)
       // adding ".0" to deal with the integer found
         threshold += ".0";
     } else if (strcmp(node.name(), "split") == 0) {
@@ -65,12 +65,25 @@ void model_node_to_conditional_operators(pugi::xml_node &nodes,
     os << prediction;
   else {
     /// \todo TODO: this should be changed with item mapping
-    os << "( v[" << feature_id - 1 << "] <= ";
-    os << threshold << "f";
-    os << " ? ";
-    model_node_to_conditional_operators(left, os);
-    os << " : ";
-    model_node_to_conditional_operators(right, os);
+    // the likely child comes first, and the compiler is told about it
+    const float left_prob = left.attribute("prob").as_float(-1.0f);
+    const float right_prob = right.attribute("prob").as_float(-1.0f);
+    std::stringstream test;
+    test << "v[" << feature_id - 1 << "] <= " << threshold << "f";
+    if (right_prob > left_prob) {
+      os << "( __builtin_expect(!(" << test.str() << "), 1) ? ";
+      model_node_to_conditional_operators(right, os);
+      os << " : ";
+      model_node_to_conditional_operators(left, os);
+    } else {
+      if (left_prob > right_prob)
+        os << "( __builtin_expect(" << test.str() << ", 1) ? ";
+      else
+        os << "( " << test.str() << " ? ";
+      model_node_to_conditional_operators(left, os);
+      os << " : ";
+      model_node_to_conditional_operators(right, os);
+    }
     os << " )";
   }
 }
@@ -98,11 +111,14 @@ GenOpCond::generate_conditional_operators_code(const std::string model_filename,
   // let's navigate the ensemble, for each tree...
   pugi::xml_node ensemble = xml_document.child("ranker").child("ensemble");
   for (pugi::xml_node &tree : ensemble.children("tree")) {
-    float tree_weight = tree.attribute("weight").as_float();
+    // the weight is copied as a double literal, as the scores of the model
+    std::string tree_weight = tree.attribute("weight").as_string("0.0");
+    trim(tree_weight);
+    if (tree_weight.find_first_of(".eEn") == std::string::npos)
+      tree_weight += ".0";
     pugi::xml_node tree_content = tree.child("split");
     if (tree_content) {
-      source_code << std::endl << "\t\t + " << std::setprecision(3)
-                  << tree_weight << "f * ";
+      source_code << std::endl << "\t\t + " << tree_weight << " * ";
       model_node_to_conditional_operators(tree_content, source_code);
     }
   }
@@ -161,9 +161,11 @@ void GenOblivious::generate_oblivious_code(const std::string model_filename,
   pugi::xml_node ensemble = ranker.child("ensemble");
 
   // loading tree weights
-  std::vector<float> tree_weights;
+  std::vector<std::string> tree_weights;
   for (pugi::xml_node &tree : ensemble.children("tree")) {
-    tree_weights.push_back(tree.attribute("weight").as_float());
+    std::string tree_weight = tree.attribute("weight").as_string("0.0");
+    trim(tree_weight);
+    tree_weights.push_back(tree_weight);
   }
 
   // loading tree depths
@@ -242,8 +244,7 @@ void GenOblivious::generate_oblivious_code(const std::string model_filename,
   source_code << std::endl;
 
   // print tree weights
-  source_code << std::setprecision(std::numeric_limits<float>::max_digits10);
-  source_code << "const float tree_weights[N] = { ";
+  source_code << "const double tree_weights[N] = { ";
   for (size_t i = 0; i < tree_weights.size(); i++) {
     if (i != 0)
       source_code << ", ";
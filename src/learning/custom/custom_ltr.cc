@@ -21,6 +21,7 @@
  */
 #include "learning/custom/custom_ltr.h"
 
+#include <algorithm>
 #include <fstream>
 #include <iomanip>
 #include <cmath>
@@ -82,6 +83,11 @@ Score CustomLTR::score_document(const quickrank::Feature *d) const {
   return FIXED_SCORE;
 }
 
+void CustomLTR::score_batch(const Feature *docs, size_t n, size_t stride,
+                            Layout layout, Score *out) const {
+  std::fill(out, out + n, FIXED_SCORE);
+}
+
 pugi::xml_document *CustomLTR::get_xml_model() const {
   pugi::xml_document *doc = new pugi::xml_document();
   doc->set_name("ranker");
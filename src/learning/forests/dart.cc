@@ -28,6 +28,7 @@
 #include <assert.h>
 
 #include "learning/forests/dart.h"
+#include "utils/perf_counters.h"
 #include "utils/radix.h"
 
 namespace quickrank {
@@ -186,6 +187,7 @@ void Dart::learn(std::shared_ptr<quickrank::data::Dataset> training_dataset,
   // create a copy of the training datasets and put it in vertical format
   std::shared_ptr<quickrank::data::VerticalDataset> vertical_training(
       new quickrank::data::VerticalDataset(training_dataset));
+  scorer->prepare(vertical_training);
 
   best_metric_on_validation_ = std::numeric_limits<double>::lowest();
   best_metric_on_training_ = std::numeric_limits<double>::lowest();
@@ -319,15 +321,21 @@ void Dart::learn(std::shared_ptr<quickrank::data::Dataset> training_dataset,
       ensemble_model_.update_ensemble_weights(dropped_weights, false);
     }
 
-    compute_pseudoresponses(vertical_training, scorer.get());
+    {
+      QUICKRANK_PERF_PHASE("pseudo-responses");
+      compute_pseudoresponses(vertical_training, scorer.get());
+    }
 
     // update the histogram with these training_setting labels
     // (the feature histogram will be used to find the best tree rtnode)
     hist_->update(pseudoresponses_, vertical_training->num_instances());
 
     // Fit a regression tree
-    std::shared_ptr<RegressionTree> tree =
-        fit_regressor_on_gradient(vertical_training);
+    std::shared_ptr<RegressionTree> tree;
+    {
+      QUICKRANK_PERF_PHASE("tree fit");
+      tree = fit_regressor_on_gradient(vertical_training);
+    }
 
     // Update scores_contribution_ including last tree
     update_contribution_scores(training_dataset, tree,
@@ -532,6 +540,9 @@ void Dart::learn(std::shared_ptr<quickrank::data::Dataset> training_dataset,
     ensemble_model_.update_ensemble_weights(best_weights, true);
   }
 
+  // trees are scored through their flattened representation from now on
+  ensemble_model_.flatten();
+
   auto chrono_train_end = std::chrono::high_resolution_clock::now();
   double train_time = std::chrono::duration_cast<std::chrono::duration<double>>(
       chrono_train_end - chrono_train_start).count();
@@ -969,14 +980,9 @@ double Dart::get_weight_last_tree(std::shared_ptr<data::Dataset> dataset,
       }
     }
 
-    #pragma omp parallel for
-    for (unsigned int p = 0; p < weights.size(); ++p) {
-      // Each thread computes the metric on some points of the window.
-      // Thread p-th computes score on a part of the training_score vector
-      // Operator & is used to obtain the first position of the sub-array
-      metric_scores[p] = scorer->evaluate_dataset(
-          dataset, &scores[num_instances * p]);
-    }
+    // Computes the metric on all the weights in a single pass
+    scorer->evaluate_dataset_batch(dataset, &scores[0], weights.size(),
+                                   &metric_scores[0]);
 
     // Find the best metric score
     auto i_max_metric_score = std::max_element(metric_scores.cbegin(),
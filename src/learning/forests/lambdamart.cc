@@ -23,6 +23,7 @@
 
 #include <fstream>
 #include <iomanip>
+#include <vector>
 
 namespace quickrank {
 namespace learning {
@@ -78,36 +79,41 @@ void LambdaMart::compute_pseudoresponses(
     auto ranked = std::shared_ptr<data::RankedResults>(
         new data::RankedResults(qr, scores_on_training_ + offset));
 
-    std::unique_ptr<Jacobian> jacobian = scorer->jacobian(ranked);
+    // metric changes are computed one row at a time,
+    // the full jacobian is stored only by metrics lacking a specialized kernel
+    std::unique_ptr<metric::ir::Metric::SwapDeltas> swap_deltas =
+        scorer->swap_deltas(ranked);
+    static thread_local std::vector<double> deltas;
+    deltas.resize(ranked->num_results());
 
     // \todo TODO: rank by label once and for all ?
     // \todo TODO: avoid n^2 loop ?
-    for (size_t j = 0; j < ranked->num_results(); j++) {
+    // pairs with both documents beyond the top-K results are skipped
+    for (size_t j = 0; j < ranked->num_results() && j < cutoff; j++) {
+      swap_deltas->row(j, deltas.data());
       Label jthlabel = ranked->sorted_labels()[j];
-      for (size_t k = 0; k < ranked->num_results(); k++)
-        if (k != j) {
-          // skip if we are beyond the top-K results
-          if (j >= cutoff && k >= cutoff)
-            break;
-
-          Label kthlabel = ranked->sorted_labels()[k];
-          if (jthlabel > kthlabel) {
-            double deltandcg = fabs(jacobian->at(j, k));
-
-            double rho = 1.0
-                / (1.0
-                    + exp(
-                        scores_on_training_[offset + ranked->pos_of_rank(j)]
-                            - scores_on_training_[offset
-                                + ranked->pos_of_rank(k)]));
-            double lambda = rho * deltandcg;
-            double delta = rho * (1.0 - rho) * deltandcg;
-            lambdas[ranked->pos_of_rank(j)] += lambda;
-            lambdas[ranked->pos_of_rank(k)] -= lambda;
-            weights[ranked->pos_of_rank(j)] += delta;
-            weights[ranked->pos_of_rank(k)] += delta;
-          }
+      for (size_t k = j + 1; k < ranked->num_results(); k++) {
+        Label kthlabel = ranked->sorted_labels()[k];
+        if (jthlabel != kthlabel) {
+          // hi is the rank of the most relevant document of the pair
+          const size_t hi = jthlabel > kthlabel ? j : k;
+          const size_t lo = jthlabel > kthlabel ? k : j;
+          double deltandcg = fabs(deltas[k]);
+
+          double rho = 1.0
+              / (1.0
+                  + exp(
+                      scores_on_training_[offset + ranked->pos_of_rank(hi)]
+                          - scores_on_training_[offset
+                              + ranked->pos_of_rank(lo)]));
+          double lambda = rho * deltandcg;
+          double delta = rho * (1.0 - rho) * deltandcg;
+          lambdas[ranked->pos_of_rank(hi)] += lambda;
+          lambdas[ranked->pos_of_rank(lo)] -= lambda;
+          weights[ranked->pos_of_rank(hi)] += delta;
+          weights[ranked->pos_of_rank(lo)] += delta;
         }
+      }
     }
   }
 }
@@ -21,10 +21,14 @@
  */
 #include "learning/forests/mart.h"
 
+#include <algorithm>
 #include <fstream>
 #include <iomanip>
 #include <chrono>
 
+#include "io/checkpoint_log.h"
+#include "metric/ir/evaluator.h"
+#include "utils/perf_counters.h"
 #include "utils/radix.h"
 
 namespace quickrank {
@@ -71,6 +75,22 @@ Mart::Mart(const pugi::xml_document &model) {
 
     ensemble_model_.push(root, tree_weight, -1);
   }
+
+  ensemble_model_.flatten();
+}
+
+bool Mart::is_valid_xml_model(const pugi::xml_document &model) {
+  pugi::xml_node model_info = model.child("ranker").child("info");
+  pugi::xml_node model_tree = model.child("ranker").child("ensemble");
+
+  size_t num_trees = 0;
+  for (const auto &tree: model_tree.children()) {
+    if (!RTNode::is_valid_xml(tree.child("split")))
+      return false;
+    ++num_trees;
+  }
+  const int max_trees = model_info.child("trees").text().as_int();
+  return max_trees >= 0 && num_trees <= (size_t) max_trees;
 }
 
 Mart::~Mart() {
@@ -201,6 +221,19 @@ void Mart::learn(std::shared_ptr<quickrank::data::Dataset> training_dataset,
   // create a copy of the training datasets and put it in vertical format
   std::shared_ptr<quickrank::data::VerticalDataset> vertical_training(
       new quickrank::data::VerticalDataset(training_dataset));
+  scorer->prepare(vertical_training);
+
+  // the additional validation metrics share the ranking of the validation
+  // results lists with the training metric
+  std::unique_ptr<quickrank::metric::ir::Evaluator> validation_evaluator;
+  if (validation_dataset && !validation_metrics_.empty()) {
+    std::vector<std::shared_ptr<quickrank::metric::ir::Metric>> metrics = {
+        scorer};
+    metrics.insert(metrics.end(), validation_metrics_.begin(),
+                   validation_metrics_.end());
+    validation_evaluator.reset(new quickrank::metric::ir::Evaluator(metrics));
+    validation_evaluator->prepare(validation_dataset);
+  }
 
   best_metric_on_validation_ = std::numeric_limits<double>::lowest();
   best_metric_on_training_ = std::numeric_limits<double>::lowest();
@@ -244,7 +277,11 @@ void Mart::learn(std::shared_ptr<quickrank::data::Dataset> training_dataset,
 
   std::cout << "# Training:" << std::endl;
   std::cout << "# -------------------------" << std::endl;
-  std::cout << "# iter. training validation" << std::endl;
+  std::cout << "# iter. training validation";
+  if (validation_evaluator)
+    for (auto metric: validation_metrics_)
+      std::cout << std::setw(9) << *metric;
+  std::cout << std::endl;
   std::cout << "# -------------------------" << std::endl;
 
   // shows the performance of the already trained model..
@@ -258,6 +295,16 @@ void Mart::learn(std::shared_ptr<quickrank::data::Dataset> training_dataset,
     std::cout << " *" << std::endl;
   }
 
+  // partial models are appended to a checkpoint log, starting with the trees
+  // of the previously saved model, if any
+  std::unique_ptr<io::CheckpointLog> checkpoint_log;
+  size_t checkpoint_size = ensemble_model_.get_size();
+  if (partial_save != 0 and !output_basename.empty()) {
+    std::unique_ptr<pugi::xml_document> model(get_xml_model());
+    checkpoint_log.reset(
+        new io::CheckpointLog(output_basename + ".ckpt", *model));
+  }
+
   auto chrono_train_start = std::chrono::high_resolution_clock::now();
 
   // start iterations from 0 or (ensemble_size - 1)
@@ -266,15 +313,21 @@ void Mart::learn(std::shared_ptr<quickrank::data::Dataset> training_dataset,
         && (valid_iterations_ && m > best_model_ + valid_iterations_))
       break;
 
-    compute_pseudoresponses(vertical_training, scorer.get());
+    {
+      QUICKRANK_PERF_PHASE("pseudo-responses");
+      compute_pseudoresponses(vertical_training, scorer.get());
+    }
 
     // update the histogram with these training_setting labels
     // (the feature histogram will be used to find the best tree rtnode)
     hist_->update(pseudoresponses_, training_dataset->num_instances());
 
     //Fit a regression tree
-    std::unique_ptr<RegressionTree>
-        tree = fit_regressor_on_gradient(vertical_training);
+    std::unique_ptr<RegressionTree> tree;
+    {
+      QUICKRANK_PERF_PHASE("tree fit");
+      tree = fit_regressor_on_gradient(vertical_training);
+    }
 
     //add this tree to the ensemble (our model)
     ensemble_model_.push(tree->get_proot(), shrinkage_, 0);  // maxlabel);
@@ -294,9 +347,19 @@ void Mart::learn(std::shared_ptr<quickrank::data::Dataset> training_dataset,
       update_modelscores(validation_dataset, scores_on_validation_, tree.get());
 
       // run metric
-      quickrank::MetricScore metric_on_validation = scorer->evaluate_dataset(
-          validation_dataset, scores_on_validation_);
-      std::cout << std::setw(9) << metric_on_validation;
+      quickrank::MetricScore metric_on_validation;
+      if (validation_evaluator) {
+        std::vector<quickrank::MetricScore> metric_scores =
+            validation_evaluator->evaluate_dataset(validation_dataset,
+                                                   scores_on_validation_);
+        metric_on_validation = metric_scores[0];
+        for (auto metric_score: metric_scores)
+          std::cout << std::setw(9) << metric_score;
+      } else {
+        metric_on_validation = scorer->evaluate_dataset(
+            validation_dataset, scores_on_validation_);
+        std::cout << std::setw(9) << metric_on_validation;
+      }
 
       if (metric_on_validation > best_metric_on_validation_) {
         best_metric_on_training_ = metric_on_training;
@@ -313,13 +376,20 @@ void Mart::learn(std::shared_ptr<quickrank::data::Dataset> training_dataset,
     }
     std::cout << std::endl;
 
-    if (partial_save != 0 and !output_basename.empty()
-        and (m + 1) % partial_save == 0) {
-      save(output_basename, m + 1);
+    if (checkpoint_log and (m + 1) % partial_save == 0) {
+      std::vector<std::pair<const RTNode *, double>> trees;
+      for (size_t t = checkpoint_size; t < ensemble_model_.get_size(); ++t)
+        trees.emplace_back(ensemble_model_.getTree(t),
+                           ensemble_model_.getWeight(t));
+      checkpoint_log->append(std::move(trees));
+      checkpoint_size = ensemble_model_.get_size();
     }
 
   }
 
+  // pending checkpoints are written before trees are removed
+  checkpoint_log.reset();
+
   //Rollback to the best model observed on the validation data
   if (validation_dataset) {
     while (ensemble_model_.is_notempty()
@@ -328,6 +398,9 @@ void Mart::learn(std::shared_ptr<quickrank::data::Dataset> training_dataset,
     }
   }
 
+  // trees are scored through their flattened representation from now on
+  ensemble_model_.flatten();
+
   auto chrono_train_end = std::chrono::high_resolution_clock::now();
   double train_time = std::chrono::duration_cast<std::chrono::duration<double>>(
       chrono_train_end - chrono_train_start).count();
@@ -371,15 +444,27 @@ std::unique_ptr<RegressionTree> Mart::fit_regressor_on_gradient(
   return std::unique_ptr<RegressionTree>(tree);
 }
 
+void Mart::score_batch(const Feature *docs, size_t n, size_t stride,
+                       Layout layout, Score *out) const {
+  std::fill(out, out + n, 0.0);
+  if (layout == Layout::ROW_MAJOR)
+    ensemble_model_.add_scores(docs, n, stride, 1, out);
+  else
+    ensemble_model_.add_scores(docs, n, 1, stride, out);
+}
+
 void Mart::update_modelscores(std::shared_ptr<data::Dataset> dataset,
                               Score *scores, RegressionTree *tree) {
   const quickrank::Feature *d = dataset->at(0, 0);
-  const size_t offset = 1;
+  const size_t num_instances = dataset->num_instances();
   const size_t num_features = dataset->num_features();
+  const size_t last_tree = ensemble_model_.get_size() - 1;
   #pragma omp parallel for
-  for (size_t i = 0; i < dataset->num_instances(); ++i) {
-    scores[i] += shrinkage_ * tree->get_proot()->score_instance(
-        d + i * num_features, offset);
+  for (size_t i = 0; i < num_instances; i += BATCH_SIZE) {
+    ensemble_model_.add_scores(d + i * num_features,
+                               std::min(BATCH_SIZE, num_instances - i),
+                               num_features, 1, scores + i, last_tree,
+                               last_tree + 1);
   }
 }
 
@@ -387,11 +472,13 @@ void Mart::update_modelscores(std::shared_ptr<data::VerticalDataset> dataset,
                               Score *scores, RegressionTree *tree) {
 
   const quickrank::Feature *d = dataset->at(0, 0);
-  const size_t offset = dataset->num_instances();
+  const size_t num_instances = dataset->num_instances();
+  const size_t last_tree = ensemble_model_.get_size() - 1;
   #pragma omp parallel for
-  for (size_t i = 0; i < dataset->num_instances(); ++i) {
-    scores[i] += shrinkage_ * tree->get_proot()->score_instance(
-        d + i, offset);
+  for (size_t i = 0; i < num_instances; i += BATCH_SIZE) {
+    ensemble_model_.add_scores(d + i, std::min(BATCH_SIZE, num_instances - i),
+                               1, num_instances, scores + i, last_tree,
+                               last_tree + 1);
   }
 }
 
@@ -414,6 +501,29 @@ pugi::xml_document *Mart::get_xml_model() const {
   return doc;
 }
 
+void Mart::save_binary(const std::string &model_filename) const {
+  // the info parameters are the same of the XML model
+  std::unique_ptr<pugi::xml_document> doc(get_xml_model());
+  std::vector<std::pair<std::string, std::string>> info;
+  for (const auto &node: doc->child("ranker").child("info").children())
+    info.emplace_back(node.name(), node.child_value());
+
+  std::ofstream os(model_filename, std::ofstream::binary);
+  io::BinaryModel::write_header(os, info);
+  ensemble_model_.write_binary(os);
+  if (!os) {
+    std::cerr << "!!! Model " + model_filename + " cannot be written."
+              << std::endl;
+    exit(EXIT_FAILURE);
+  }
+}
+
+bool Mart::map_binary_model(
+    std::shared_ptr<const io::BinaryModel> binary_model) {
+  return ensemble_model_.map_binary(binary_model->data(),
+                                    binary_model->data_size(), binary_model);
+}
+
 bool Mart::import_model_state(LTR_Algorithm &other) {
 
   // Check the object is derived from Mart
@@ -23,6 +23,7 @@
  */
 #include "learning/forests/rankboost.h"
 
+#include <algorithm>
 #include <fstream>
 #include <iomanip>
 #include <cmath>
@@ -526,6 +527,38 @@ Score Rankboost::score_document(const quickrank::Feature *d) const {
   return doc_score;
 }
 
+size_t Rankboost::num_features() const {
+  size_t num_features = 0;
+  for (unsigned int t = 0; t < best_T; t++)
+    num_features = std::max(num_features,
+                            (size_t) weak_rankers[t]->get_feature_id() + 1);
+  return num_features;
+}
+
+void Rankboost::score_batch(const Feature *docs, size_t n, size_t stride,
+                            Layout layout, Score *out) const {
+  // the scores of a block of documents are kept in registers
+  const size_t BLOCK_SIZE = 16;
+  const size_t instance_offset = layout == Layout::ROW_MAJOR ? stride : 1;
+  const size_t feature_offset = layout == Layout::ROW_MAJOR ? 1 : stride;
+  for (size_t i = 0; i < n; i += BLOCK_SIZE) {
+    const size_t num_block = std::min(BLOCK_SIZE, n - i);
+    const Feature *block = docs + i * instance_offset;
+    double sums[BLOCK_SIZE] = {0.0};
+    for (unsigned int t = 0; t < best_T; t++) {
+      const Feature *values =
+          block + weak_rankers[t]->get_feature_id() * feature_offset;
+      const int sign = weak_rankers[t]->get_sign();
+      const Feature theta = weak_rankers[t]->get_theta();
+      for (size_t j = 0; j < num_block; ++j)
+        sums[j] += alphas[t]
+            * (unsigned int) (sign * values[j * instance_offset]
+                > sign * theta);
+    }
+    std::copy(sums, sums + num_block, out + i);
+  }
+}
+
 std::shared_ptr<std::vector<Score>> Rankboost::partial_scores_document(
     const Feature *d, bool ignore_weights) const {
   std::vector<quickrank::Score> scores(best_T);
@@ -22,6 +22,7 @@
  *  - Claudio Lucchese (claudio.lucchese@isti.cnr.it)
  */
 #include "learning/linear/coordinate_ascent.h"
+#include "learning/linear/dot_product.h"
 
 #include <fstream>
 #include <iomanip>
@@ -177,14 +178,13 @@ void CoordinateAscent::learn(
           MyTrainingScore[j + (n_train_instances * p)] = points[p]
               * training_dataset->at(j, i)[0] + PreSum[j];
         }
-        // each thread computes NDCG on some points of the window
-        // scorer gets a part of array MyTrainingScore for the thread p-th
-        // Operator & is used to obtain the first position of the sub-array
-        MyNDCGs[p] = scorer->evaluate_dataset(
-            training_dataset, &MyTrainingScore[n_train_instances * p]);
       }
       // End parallel
 
+      // compute NDCG on all the points of the window in a single pass
+      scorer->evaluate_dataset_batch(training_dataset, &MyTrainingScore[0],
+                                     points.size(), &MyNDCGs[0]);
+
       // Find the best NDCG
       auto i_max_ndcg = std::max_element(MyNDCGs.cbegin(), MyNDCGs.cend());
       if (*i_max_ndcg > metric_on_training) {
@@ -255,6 +255,12 @@ Score CoordinateAscent::score_document(const Feature *d) const {
   return score;
 }
 
+void CoordinateAscent::score_batch(const Feature *docs, size_t n,
+                                   size_t stride, Layout layout,
+                                   Score *out) const {
+  dot_product_batch(best_weights_, docs, n, stride, layout, out);
+}
+
 bool CoordinateAscent::update_weights(std::vector<double>& weights) {
 
   if (weights.size() != best_weights_.size())
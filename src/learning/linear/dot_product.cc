@@ -0,0 +1,61 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include <algorithm>
+
+#include "learning/linear/dot_product.h"
+
+namespace quickrank {
+namespace learning {
+namespace linear {
+
+void dot_product_batch(const std::vector<double> &weights, const Feature *docs,
+                       size_t n, size_t stride, Layout layout, Score *out) {
+  // the dot products of a block of documents are kept in registers
+  const size_t BLOCK_SIZE = 16;
+  const size_t num_features = weights.size();
+  for (size_t i = 0; i < n; i += BLOCK_SIZE) {
+    const size_t num_block = std::min(BLOCK_SIZE, n - i);
+    double sums[BLOCK_SIZE] = {0.0};
+    if (layout == Layout::ROW_MAJOR) {
+      const Feature *block = docs + i * stride;
+      for (size_t k = 0; k < num_features; ++k) {
+        const double weight = weights[k];
+        for (size_t j = 0; j < num_block; ++j)
+          sums[j] += weight * block[j * stride + k];
+      }
+    } else {
+      // the values of a feature in the block are contiguous
+      const Feature *block = docs + i;
+      for (size_t k = 0; k < num_features; ++k) {
+        const double weight = weights[k];
+        const Feature *values = block + k * stride;
+        for (size_t j = 0; j < num_block; ++j)
+          sums[j] += weight * values[j];
+      }
+    }
+    std::copy(sums, sums + num_block, out + i);
+  }
+}
+
+}  // namespace linear
+}  // namespace learning
+}  // namespace quickrank
@@ -20,6 +20,7 @@
  *  - Salvatore Trani (salvatore.trani@isti.cnr.it)
  */
 #include "learning/linear/line_search.h"
+#include "learning/linear/dot_product.h"
 
 #include <chrono>
 #include <sstream>
@@ -269,14 +270,9 @@ void LineSearch::learn(
         }
       }
 
-#pragma omp parallel for
-      for (unsigned int p = 0; p < points.size(); ++p) {
-        // Each thread computes the metric on some points of the window.
-        // Thread p-th computes score on a part of the training_score vector
-        // Operator & is used to obtain the first position of the sub-array
-        metric_scores[p] = scorer->evaluate_dataset(
-            training_dataset, &training_score[num_train_instances * p]);
-      }
+      // Computes the metric on all the points of the window in a single pass
+      scorer->evaluate_dataset_batch(training_dataset, &training_score[0],
+                                     points.size(), &metric_scores[0]);
 
       // Find the best metric score
       auto i_max_metric_score = std::max_element(metric_scores.cbegin(),
@@ -316,14 +312,9 @@ void LineSearch::learn(
         }
       }
 
-#pragma omp parallel for
-      for (unsigned int p = 0; p < num_points + 1; ++p) {
-        // Each thread computes the metric on some points of the window.
-        // Thread p-th computes score on a part of the training_score vector
-        // Operator & is used to obtain the first position of the sub-array
-        metric_scores[p] = scorer->evaluate_dataset(
-            training_dataset, &training_score[num_train_instances * p]);
-      }
+      // Computes the metric on all the points of the window in a single pass
+      scorer->evaluate_dataset_batch(training_dataset, &training_score[0],
+                                     num_points + 1, &metric_scores[0]);
 
       // Find the best metric score
       auto i_max_metric_score = std::max_element(metric_scores.cbegin(),
@@ -426,6 +417,11 @@ Score LineSearch::score_document(const Feature *d) const {
   return score;
 }
 
+void LineSearch::score_batch(const Feature *docs, size_t n, size_t stride,
+                             Layout layout, Score *out) const {
+  dot_product_batch(best_weights_, docs, n, stride, layout, out);
+}
+
 bool LineSearch::update_weights(std::vector<double>& weights) {
 
   if (weights.size() != best_weights_.size()) {
@@ -19,10 +19,12 @@
  * Contributor:
  *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
  */
+#include <algorithm>
 #include <fstream>
 
 #include "pugixml/src/pugixml.hpp"
 #include "learning/ltr_algorithm.h"
+#include "io/checkpoint_log.h"
 
 #include "learning/forests/mart.h"
 #include "learning/forests/dart.h"
@@ -36,22 +38,33 @@
 // Added by Salvatore Trani
 #include "learning/linear/line_search.h"
 #include "optimization/post_learning/cleaver/cleaver.h"
+#include "utils/perf_counters.h"
 
 namespace quickrank {
 namespace learning {
 
+const size_t LTR_Algorithm::BATCH_SIZE;
+
 void LTR_Algorithm::score_dataset(std::shared_ptr<data::Dataset> dataset,
                                   Score *scores) const {
+  QUICKRANK_PERF_PHASE("scoring");
   const quickrank::Feature *d = dataset->at(0, 0);
+  const size_t num_instances = dataset->num_instances();
+  const size_t num_features = dataset->num_features();
   #pragma omp parallel for
-  for (size_t i = 0; i < dataset->num_instances(); i++) {
-    scores[i] = score_document(d + i * dataset->num_features());
-//    d += dataset->num_features();
+  for (size_t i = 0; i < num_instances; i += BATCH_SIZE) {
+    score_batch(d + i * num_features, std::min(BATCH_SIZE, num_instances - i),
+                num_features, Layout::ROW_MAJOR, scores + i);
   }
 }
 
 void LTR_Algorithm::save(std::string output_basename, int iteration) const {
-  if (!output_basename.empty()) {
+  if (!output_basename.empty() && model_format_ == ModelFormat::BINARY) {
+    std::string filename(output_basename);
+    if (iteration != -1)
+      filename += ".T" + std::to_string(iteration) + ".bin";
+    save_binary(filename);
+  } else if (!output_basename.empty()) {
     std::string filename(output_basename);
     if (iteration != -1)
       filename += ".T" + std::to_string(iteration) + ".xml";
@@ -63,6 +76,47 @@ void LTR_Algorithm::save(std::string output_basename, int iteration) const {
   }
 }
 
+void LTR_Algorithm::save_binary(const std::string &model_filename) const {
+  std::cerr << "!!! " << name() << " does not support the binary model format."
+            << std::endl;
+  exit(EXIT_FAILURE);
+}
+
+namespace {
+
+/// Loads a model from its info parameters and maps the data of the binary
+/// model, or returns a null pointer if its type does not support it.
+std::shared_ptr<LTR_Algorithm> map_binary(
+    std::shared_ptr<const io::BinaryModel> binary_model) {
+
+  // the model is created from its info parameters only
+  pugi::xml_document info_model;
+  pugi::xml_node info = info_model.append_child("ranker").append_child("info");
+  for (const auto &pair: binary_model->info())
+    info.append_child(pair.first.c_str()).text() = pair.second.c_str();
+
+  std::shared_ptr<LTR_Algorithm> model =
+      LTR_Algorithm::load_model_from_xml(info_model);
+  if (!model || !model->map_binary_model(binary_model)) {
+    std::cerr << "!!! Binary model of type "
+              << info.child("type").child_value() << " is not supported."
+              << std::endl;
+    return nullptr;
+  }
+  return model;
+}
+
+/// Returns true if the given type of model is loaded by the Mart constructor.
+bool is_tree_ensemble(const std::string &ranker_type) {
+  return ranker_type == forests::Mart::NAME_
+      || ranker_type == forests::Dart::NAME_
+      || ranker_type == forests::LambdaMart::NAME_
+      || ranker_type == forests::ObliviousMart::NAME_
+      || ranker_type == forests::ObliviousLambdaMart::NAME_;
+}
+
+}  // namespace
+
 std::shared_ptr<LTR_Algorithm> LTR_Algorithm::load_model_from_file(
     std::string model_filename) {
   if (model_filename.empty()) {
@@ -70,6 +124,21 @@ std::shared_ptr<LTR_Algorithm> LTR_Algorithm::load_model_from_file(
     exit(EXIT_FAILURE);
   }
 
+  if (io::BinaryModel::is_binary_model(model_filename))
+    return load_model_from_binary(
+        std::make_shared<io::BinaryModel>(model_filename));
+
+  // a checkpoint log is loaded as the model of its last checkpoint
+  if (io::CheckpointLog::is_checkpoint_log(model_filename)) {
+    pugi::xml_document model;
+    if (!io::CheckpointLog::read(model_filename, model)) {
+      std::cerr << "!!! Checkpoint log " + model_filename + " is not valid."
+                << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    return load_model_from_xml(model);
+  }
+
   pugi::xml_document model;
   pugi::xml_parse_result result = model.load_file(model_filename.c_str());
   if (!result) {
@@ -81,6 +150,57 @@ std::shared_ptr<LTR_Algorithm> LTR_Algorithm::load_model_from_file(
   return load_model_from_xml(model);
 }
 
+std::shared_ptr<LTR_Algorithm> LTR_Algorithm::try_load_model_from_file(
+    const std::string &model_filename) {
+  if (!std::ifstream(model_filename)) {
+    std::cerr << "!!! Model " + model_filename + " cannot be opened."
+              << std::endl;
+    return nullptr;
+  }
+
+  if (io::BinaryModel::is_binary_model(model_filename)) {
+    auto binary_model = io::BinaryModel::open(model_filename);
+    return binary_model ? map_binary(binary_model) : nullptr;
+  }
+
+  pugi::xml_document model;
+  if (io::CheckpointLog::is_checkpoint_log(model_filename)) {
+    if (!io::CheckpointLog::read(model_filename, model)) {
+      std::cerr << "!!! Checkpoint log " + model_filename + " is not valid."
+                << std::endl;
+      return nullptr;
+    }
+  } else if (!model.load_file(model_filename.c_str())) {
+    std::cerr << "!!! Model " + model_filename + " is not parsed correctly."
+              << std::endl;
+    return nullptr;
+  }
+
+  // the trees are checked before the ensemble is built
+  std::string ranker_type =
+      model.child("ranker").child("info").child("type").child_value();
+  if (is_tree_ensemble(ranker_type)
+      && !forests::Mart::is_valid_xml_model(model)) {
+    std::cerr << "!!! Unable to parse tree from XML model " + model_filename
+        + "." << std::endl;
+    return nullptr;
+  }
+
+  std::shared_ptr<LTR_Algorithm> ranker = load_model_from_xml(model);
+  if (!ranker)
+    std::cerr << "!!! Model type " + ranker_type + " is not supported."
+              << std::endl;
+  return ranker;
+}
+
+std::shared_ptr<LTR_Algorithm> LTR_Algorithm::load_model_from_binary(
+    std::shared_ptr<const io::BinaryModel> binary_model) {
+  std::shared_ptr<LTR_Algorithm> model = map_binary(binary_model);
+  if (!model)
+    exit(EXIT_FAILURE);
+  return model;
+}
+
 std::shared_ptr<LTR_Algorithm> LTR_Algorithm::load_model_from_xml(
     const pugi::xml_document& xml_model) {
 
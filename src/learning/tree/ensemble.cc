@@ -19,8 +19,12 @@
  * Contributor:
  *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
  */
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <iomanip>
+#include <limits>
+#include <sstream>
 
 #include "learning/tree/ensemble.h"
 
@@ -28,7 +32,12 @@ Ensemble::Ensemble(Ensemble&& other) {
   size = other.size;
   capacity = other.capacity;
   arr = other.arr;
+  // moving the arrays keeps their storage, and the view on it
+  flat_arrays_ = std::move(other.flat_arrays_);
+  flat_ = other.flat_;
+  mapping_ = std::move(other.mapping_);
   // reset source object
+  other.flat_ = flat_view();
   other.arr = nullptr;
   other.size = 0;
   other.capacity = 0;
@@ -48,6 +57,21 @@ void Ensemble::reset_state() {
   }
   size = 0;
   capacity = 0;
+  reset_flat();
+}
+
+void Ensemble::reset_flat() {
+  unmap();
+  flat_arrays_ = flat_arrays();
+  flat_ = flat_view();
+}
+
+void Ensemble::unmap() {
+  if (!mapping_)
+    return;
+  for (size_t i = 0; i < size; ++i)
+    getTree(i);
+  mapping_.reset();
 }
 
 Ensemble& Ensemble::operator=(Ensemble&& other) {
@@ -58,7 +82,11 @@ Ensemble& Ensemble::operator=(Ensemble&& other) {
     size = other.size;
     capacity = other.capacity;
     arr = other.arr;
+    flat_arrays_ = std::move(other.flat_arrays_);
+    flat_ = other.flat_;
+    mapping_ = std::move(other.mapping_);
     // reset source object
+    other.flat_ = flat_view();
     other.arr = nullptr;
     other.size = 0;
     other.capacity = 0;
@@ -68,6 +96,7 @@ Ensemble& Ensemble::operator=(Ensemble&& other) {
 }
 
 void Ensemble::set_capacity(const size_t n) {
+  reset_flat();
 
   if (arr) {
 
@@ -101,29 +130,217 @@ void Ensemble::push(RTNode *root, const double weight, const float maxlabel) {
   }
 
   arr[size++] = weighted_tree(root, weight, maxlabel);
+  reset_flat();
 }
 
 void Ensemble::pop() {
   delete arr[--size].root;
+  reset_flat();
+}
+
+void Ensemble::flatten() {
+  reset_flat();
+  // features beyond the range of the flattened nodes are scored on the
+  // tree nodes
+  if (!flatten_trees(flat_arrays_)) {
+    flat_arrays_ = flat_arrays();
+    return;
+  }
+  flat_.num_trees = flat_arrays_.trees.size();
+  flat_.num_nodes = flat_arrays_.features.size();
+  flat_.num_leaves = flat_arrays_.leaves.size();
+  flat_.num_used_features = flat_arrays_.used_features.size();
+  flat_.trees = flat_arrays_.trees.data();
+  flat_.features = flat_arrays_.features.data();
+  flat_.dense_features = flat_arrays_.dense_features.data();
+  flat_.used_features = flat_arrays_.used_features.data();
+  flat_.thresholds = flat_arrays_.thresholds.data();
+  flat_.children = flat_arrays_.children.data();
+  flat_.probabilities = flat_arrays_.probabilities.data();
+  flat_.leaves = flat_arrays_.leaves.data();
+}
+
+size_t Ensemble::num_features() const {
+  if (is_flat())
+    return flat_.num_used_features ?
+           flat_.used_features[flat_.num_used_features - 1] + 1 : 0;
+
+  size_t num_features = 0;
+  std::vector<const RTNode *> nodes;
+  for (size_t i = 0; i < size; ++i) {
+    nodes.push_back(getTree(i));
+    while (!nodes.empty()) {
+      const RTNode *node = nodes.back();
+      nodes.pop_back();
+      if (node->is_leaf())
+        continue;
+      num_features = std::max(num_features, node->get_feature_idx() + 1);
+      nodes.push_back(node->left);
+      nodes.push_back(node->right);
+    }
+  }
+  return num_features;
+}
+
+bool Ensemble::flatten_trees(flat_arrays &flat) const {
+  for (size_t i = 0; i < size; ++i) {
+    flat_tree tree;
+    tree.first_node = flat.features.size();
+    tree.first_leaf = flat.leaves.size();
+    tree.root = flatten_node(arr[i].root, flat, tree.first_node,
+                             tree.first_leaf);
+    if (tree.root == INT32_MIN)
+      return false;
+    flat.trees.push_back(tree);
+  }
+
+  // the features used by the trees are remapped to a dense range, so that
+  // batches of documents can be gathered into short rows
+  flat.used_features = flat.features;
+  std::sort(flat.used_features.begin(), flat.used_features.end());
+  flat.used_features.erase(std::unique(flat.used_features.begin(),
+                                       flat.used_features.end()),
+                           flat.used_features.end());
+  flat.dense_features.resize(flat.features.size());
+  for (size_t i = 0; i < flat.features.size(); ++i)
+    flat.dense_features[i] = std::lower_bound(flat.used_features.begin(),
+                                              flat.used_features.end(),
+                                              flat.features[i])
+        - flat.used_features.begin();
+  return true;
+}
+
+int32_t Ensemble::flatten_node(const RTNode *node, flat_arrays &flat,
+                               size_t first_node, size_t first_leaf) const {
+  if (node->is_leaf()) {
+    flat.leaves.push_back(node->avglabel);
+    return ~(int32_t) (flat.leaves.size() - 1 - first_leaf);
+  }
+  if (node->get_feature_idx() > UINT16_MAX)
+    return INT32_MIN;
+
+  const size_t index = flat.features.size();
+  flat.features.push_back(node->get_feature_idx());
+  flat.thresholds.push_back(node->threshold);
+  flat.children.push_back(0);
+  flat.children.push_back(0);
+  flat.probabilities.push_back(node->left->probability);
+  flat.probabilities.push_back(node->right->probability);
+  // the likely child follows its parent, so that the hot path of the tree
+  // is stored contiguously
+  int32_t left, right;
+  if (node->is_right_likely()) {
+    right = flatten_node(node->right, flat, first_node, first_leaf);
+    left = flatten_node(node->left, flat, first_node, first_leaf);
+  } else {
+    left = flatten_node(node->left, flat, first_node, first_leaf);
+    right = flatten_node(node->right, flat, first_node, first_leaf);
+  }
+  if (left == INT32_MIN || right == INT32_MIN)
+    return INT32_MIN;
+  flat.children[2 * index] = left;
+  flat.children[2 * index + 1] = right;
+  return index - first_node;
+}
+
+RTNode *Ensemble::unflatten_node(size_t i, int32_t node) const {
+  const flat_tree &tree = flat_.trees[i];
+  if (node < 0)
+    return new RTNode(flat_.leaves[tree.first_leaf + ~node]);
+  const size_t index = tree.first_node + node;
+  RTNode *left = unflatten_node(i, flat_.children[2 * index]);
+  RTNode *right = unflatten_node(i, flat_.children[2 * index + 1]);
+  left->probability = flat_.probabilities[2 * index];
+  right->probability = flat_.probabilities[2 * index + 1];
+  return new RTNode(flat_.thresholds[index], flat_.features[index],
+                    flat_.features[index] + 1, left, right);
 }
 
 // assumes vertical dataset
 quickrank::Score Ensemble::score_instance(const quickrank::Feature *d,
                                           const size_t offset) const {
   double sum = 0.0f;
+#ifndef QUICKRANK_PERF_STATS
+  // node traversals are counted on the tree nodes only
+  if (is_flat()) {
+    for (size_t i = 0; i < size; ++i)
+      sum += score_flat_tree(i, d, offset) * arr[i].weight;
+    return sum;
+  }
+#endif
 // #pragma omp parallel for reduction(+:sum)
   for (size_t i = 0; i < size; ++i)
-    sum += arr[i].root->score_instance(d, offset) * arr[i].weight;
+    sum += getTree(i)->score_instance(d, offset) * arr[i].weight;
   return sum;
 }
 
+void Ensemble::add_scores(const quickrank::Feature *d, size_t num_instances,
+                          size_t instance_offset, size_t offset,
+                          quickrank::Score *scores, size_t first_tree,
+                          size_t last_tree) const {
+  // the scores of a block of documents are kept in registers
+  const size_t BLOCK_SIZE = 16;
+  last_tree = std::min(last_tree, size);
+  bool flat = is_flat();
+#ifdef QUICKRANK_PERF_STATS
+  // node traversals are counted on the tree nodes only
+  flat = false;
+#endif
+  // the documents are gathered into rows of the used features only, when the
+  // trees to be traversed have more nodes than the features to be copied
+  const size_t num_used = flat_.num_used_features;
+  bool gather = false;
+  if (flat && first_tree < last_tree && num_used > 0) {
+    const size_t end_node = last_tree < size ?
+                            flat_.trees[last_tree].first_node :
+                            flat_.num_nodes;
+    gather = end_node - flat_.trees[first_tree].first_node >= num_used;
+  }
+  static thread_local std::vector<quickrank::Feature> gathered;
+  if (gather)
+    gathered.resize(BLOCK_SIZE * num_used);
+
+  for (size_t i = 0; i < num_instances; i += BLOCK_SIZE) {
+    const size_t num_block = std::min(BLOCK_SIZE, num_instances - i);
+    const quickrank::Feature *block = d + i * instance_offset;
+    double sums[BLOCK_SIZE];
+    std::copy(scores + i, scores + i + num_block, sums);
+    if (gather) {
+      for (size_t j = 0; j < num_block; ++j) {
+        const quickrank::Feature *document = block + j * instance_offset;
+        quickrank::Feature *row = gathered.data() + j * num_used;
+        for (size_t k = 0; k < num_used; ++k)
+          row[k] = document[flat_.used_features[k] * offset];
+      }
+    }
+    for (size_t t = first_tree; t < last_tree; ++t) {
+      const double weight = arr[t].weight;
+      if (gather) {
+        for (size_t j = 0; j < num_block; ++j)
+          sums[j] += score_flat_tree(t, gathered.data() + j * num_used, 1,
+                                     true) * weight;
+      } else if (flat) {
+        for (size_t j = 0; j < num_block; ++j)
+          sums[j] += score_flat_tree(t, block + j * instance_offset, offset)
+              * weight;
+      } else {
+        for (size_t j = 0; j < num_block; ++j)
+          sums[j] += getTree(t)->score_instance(block + j * instance_offset,
+                                                offset) * weight;
+      }
+    }
+    std::copy(sums, sums + num_block, scores + i);
+  }
+}
+
 std::shared_ptr<std::vector<quickrank::Score>>
 Ensemble::partial_scores_instance(const quickrank::Feature *d,
                                   bool ignore_weights,
                                   const size_t offset) const {
   std::vector<quickrank::Score> scores(size);
   for (unsigned int i = 0; i < size; ++i) {
-    scores[i] = arr[i].root->score_instance(d, offset);
+    scores[i] = is_flat() ? score_flat_tree(i, d, offset) :
+                getTree(i)->score_instance(d, offset);
     if (!ignore_weights)
       scores[i] *= arr[i].weight;
   }
@@ -137,17 +354,158 @@ pugi::xml_node Ensemble::append_xml_model(pugi::xml_node parent) const {
   for (size_t i = 0; i < size; ++i) {
     pugi::xml_node tree = ensemble.append_child("tree");
     tree.append_attribute("id") = i + 1;
-    tree.append_attribute("weight") = arr[i].weight;
-    if (arr[i].root) {
-      arr[i].root->append_xml_model(tree);
+    std::stringstream weight;
+    weight << std::setprecision(std::numeric_limits<double>::max_digits10);
+    weight << arr[i].weight;
+    tree.append_attribute("weight") = weight.str().c_str();
+    if (getTree(i)) {
+      getTree(i)->append_xml_model(tree);
     }
   }
 
   return ensemble;
 }
 
+namespace {
+
+const char PADDING[8] = {0};
+
+template<typename T>
+void write_array(std::ostream &os, const T *data, size_t n) {
+  os.write(reinterpret_cast<const char *>(data), n * sizeof(T));
+  if ((n * sizeof(T)) % 8)
+    os.write(PADDING, 8 - (n * sizeof(T)) % 8);
+}
+
+/// Returns the next array of \a n items, or NULL if \a data is too short.
+template<typename T>
+const T *map_array(const char *&data, const char *end, size_t n) {
+  const size_t bytes = (n * sizeof(T) + 7) / 8 * 8;
+  if (n > (size_t) (end - data) / sizeof(T) || bytes > (size_t) (end - data))
+    return NULL;
+  const T *array = reinterpret_cast<const T *>(data);
+  data += bytes;
+  return array;
+}
+
+}  // namespace
+
+void Ensemble::write_binary(std::ostream &os) const {
+  static_assert(sizeof(flat_tree) == 24, "unexpected layout of flat_tree");
+
+  flat_view flat = flat_;
+  flat_arrays arrays;
+  if (!is_flat()) {
+    if (size > 0 && !flatten_trees(arrays)) {
+      std::cerr << "!!! The binary model format supports features up to "
+                << UINT16_MAX + 1 << " only." << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    flat.num_trees = arrays.trees.size();
+    flat.num_nodes = arrays.features.size();
+    flat.num_leaves = arrays.leaves.size();
+    flat.num_used_features = arrays.used_features.size();
+    flat.features = arrays.features.data();
+    flat.dense_features = arrays.dense_features.data();
+    flat.used_features = arrays.used_features.data();
+    flat.thresholds = arrays.thresholds.data();
+    flat.children = arrays.children.data();
+    flat.probabilities = arrays.probabilities.data();
+    flat.leaves = arrays.leaves.data();
+  }
+
+  const uint64_t sizes[4] = {flat.num_trees, flat.num_nodes, flat.num_leaves,
+                             flat.num_used_features};
+  write_array(os, sizes, 4);
+  const std::vector<double> weights = get_weights();
+  write_array(os, weights.data(), weights.size());
+  // padding bytes are written as zeros
+  for (size_t i = 0; i < flat.num_trees; ++i) {
+    const flat_tree &tree = is_flat() ? flat_.trees[i] : arrays.trees[i];
+    flat_tree record;
+    memset(&record, 0, sizeof(record));
+    record.root = tree.root;
+    record.first_node = tree.first_node;
+    record.first_leaf = tree.first_leaf;
+    write_array(os, &record, 1);
+  }
+  write_array(os, flat.features, flat.num_nodes);
+  write_array(os, flat.dense_features, flat.num_nodes);
+  write_array(os, flat.used_features, flat.num_used_features);
+  write_array(os, flat.thresholds, flat.num_nodes);
+  write_array(os, flat.children, 2 * flat.num_nodes);
+  write_array(os, flat.probabilities, 2 * flat.num_nodes);
+  write_array(os, flat.leaves, flat.num_leaves);
+}
+
+bool Ensemble::map_binary(const char *data, size_t data_size,
+                          std::shared_ptr<const void> owner) {
+  const char *end = data + data_size;
+  const uint64_t *sizes = map_array<uint64_t>(data, end, 4);
+  if (!sizes)
+    return false;
+
+  flat_view flat;
+  flat.num_trees = sizes[0];
+  flat.num_nodes = sizes[1];
+  flat.num_leaves = sizes[2];
+  flat.num_used_features = sizes[3];
+  const double *weights = map_array<double>(data, end, flat.num_trees);
+  flat.trees = map_array<flat_tree>(data, end, flat.num_trees);
+  flat.features = map_array<uint16_t>(data, end, flat.num_nodes);
+  flat.dense_features = map_array<uint16_t>(data, end, flat.num_nodes);
+  flat.used_features = map_array<uint16_t>(data, end,
+                                           flat.num_used_features);
+  flat.thresholds = map_array<float>(data, end, flat.num_nodes);
+  flat.children = map_array<int32_t>(data, end, 2 * flat.num_nodes);
+  flat.probabilities = map_array<float>(data, end, 2 * flat.num_nodes);
+  flat.leaves = map_array<double>(data, end, flat.num_leaves);
+  if (!weights || !flat.trees || !flat.features || !flat.dense_features
+      || !flat.used_features || !flat.thresholds || !flat.children
+      || !flat.probabilities
+      || !flat.leaves)
+    return false;
+
+  // trees are rebuilt, or scored, only within the bounds of the arrays
+  for (size_t i = 0; i < flat.num_trees; ++i) {
+    const flat_tree &tree = flat.trees[i];
+    const size_t end_node = i + 1 < flat.num_trees ?
+                            flat.trees[i + 1].first_node : flat.num_nodes;
+    const size_t end_leaf = i + 1 < flat.num_trees ?
+                            flat.trees[i + 1].first_leaf : flat.num_leaves;
+    if (tree.first_node > end_node || tree.first_leaf >= end_leaf)
+      return false;
+    const size_t num_nodes = end_node - tree.first_node;
+    const size_t num_leaves = end_leaf - tree.first_leaf;
+    if (num_leaves != num_nodes + 1 || (tree.root >= 0 ?
+        (size_t) tree.root >= num_nodes : (size_t) ~tree.root >= num_leaves))
+      return false;
+    for (size_t n = 2 * tree.first_node; n < 2 * end_node; ++n) {
+      const int32_t child = flat.children[n];
+      if (child >= 0 ? (size_t) child >= num_nodes
+                       || (size_t) child <= n / 2 - tree.first_node :
+          (size_t) ~child >= num_leaves)
+        return false;
+    }
+  }
+  for (size_t n = 0; n < flat.num_nodes; ++n)
+    if (flat.dense_features[n] >= flat.num_used_features
+        || flat.used_features[flat.dense_features[n]] != flat.features[n])
+      return false;
+
+  set_capacity(flat.num_trees);
+  for (size_t i = 0; i < flat.num_trees; ++i)
+    arr[i] = weighted_tree(nullptr, weights[i], 0);
+  size = flat.num_trees;
+  flat_ = flat;
+  mapping_ = owner;
+  return true;
+}
+
 bool Ensemble::filter_out_zero_weighted_trees() {
 
+  const bool flat = is_flat();
+  unmap();
   size_t idx_curr = 0;
   for (size_t i = 0; i < size; ++i) {
     if (arr[i].weight == 0) {
@@ -165,6 +523,46 @@ bool Ensemble::filter_out_zero_weighted_trees() {
   // Set the new size to the last element index (+1 because it is a size)
   size = idx_curr;
 
+  // the flattened trees follow the remaining ones
+  if (flat)
+    flatten();
+  else
+    reset_flat();
+
+  return true;
+}
+
+bool Ensemble::reorder_trees(const std::vector<size_t> &order) {
+  if (order.size() != size)
+    return false;
+  std::vector<bool> seen(size, false);
+  for (size_t i: order) {
+    if (i >= size || seen[i])
+      return false;
+    seen[i] = true;
+  }
+
+  // trees are moved by their roots, copying weighted_tree would copy them
+  const bool flat = is_flat();
+  unmap();
+  std::vector<RTNode *> roots(size);
+  std::vector<double> weights(size);
+  std::vector<float> maxlabels(size);
+  for (size_t i = 0; i < size; ++i) {
+    roots[i] = arr[order[i]].root;
+    weights[i] = arr[order[i]].weight;
+    maxlabels[i] = arr[order[i]].maxlabel;
+  }
+  for (size_t i = 0; i < size; ++i) {
+    arr[i].root = roots[i];
+    arr[i].weight = weights[i];
+    arr[i].maxlabel = maxlabels[i];
+  }
+
+  if (flat)
+    flatten();
+  else
+    reset_flat();
   return true;
 }
 
@@ -154,6 +154,7 @@ void ObliviousRT::fit(RTNodeHistogram *hist) {
         node->right = nodearray[2 * i + 2] = new RTNode(rsamples, rsize,
                                                         rsum / rsize);
       }
+      node->set_children_probability(lsize, rsize);
       node->set_feature(
           best_featureidx,
           best_featureidx + 1 /*training_set->get_featureid(best_featureidx)*/);
@@ -270,6 +270,7 @@ bool RegressionTree::split(RTNode *node, const float featuresamplingrate,
     //create children
     node->left = new RTNode(lsamples, lhist);
     node->right = new RTNode(rsamples, rhist);
+    node->set_children_probability(lsize, rsize);
 
     // rhist->quick_dump(128,10);
     // lhist->quick_dump(25,10);
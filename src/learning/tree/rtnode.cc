@@ -52,8 +52,14 @@ pugi::xml_node RTNode::append_xml_model(pugi::xml_node parent,
 
   pugi::xml_node split = parent.append_child("split");
 
-  if (!pos.empty())
+  if (!pos.empty()) {
     split.append_attribute("pos") = pos.c_str();
+    if (probability >= 0.0f) {
+      std::stringstream prob;
+      prob << probability;
+      split.append_attribute("prob") = prob.str().c_str();
+    }
+  }
 
   if (featureid == uint_max) {
 
@@ -99,10 +105,12 @@ RTNode *RTNode::parse_xml(const pugi::xml_node &split_xml) {
       threshold = split_child.text().as_float();
     } else if (strcmp(split_child.name(), "split") == 0) {
       std::string pos = split_child.attribute("pos").value();
+      RTNode *child = RTNode::parse_xml(split_child);
+      child->probability = split_child.attribute("prob").as_float(-1.0f);
       if (pos == "left")
-        left_child = RTNode::parse_xml(split_child);
+        left_child = child;
       else
-        right_child = RTNode::parse_xml(split_child);
+        right_child = child;
     }
   }
 
@@ -115,3 +123,30 @@ RTNode *RTNode::parse_xml(const pugi::xml_node &split_xml) {
 
   return model_node;
 }
+
+bool RTNode::is_valid_xml(const pugi::xml_node &split_xml) {
+  if (!split_xml)
+    return false;
+
+  bool has_left = false;
+  bool has_right = false;
+  unsigned int feature_id = 0;
+
+  for (const pugi::xml_node &split_child: split_xml.children()) {
+    if (strcmp(split_child.name(), "output") == 0) {
+      return true;
+    } else if (strcmp(split_child.name(), "feature") == 0) {
+      feature_id = split_child.text().as_uint();
+    } else if (strcmp(split_child.name(), "split") == 0) {
+      if (!RTNode::is_valid_xml(split_child))
+        return false;
+      if (std::string(split_child.attribute("pos").value()) == "left")
+        has_left = true;
+      else
+        has_right = true;
+    }
+  }
+
+  // feature ids start from 1
+  return feature_id > 0 && has_left && has_right;
+}
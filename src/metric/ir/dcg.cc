@@ -21,6 +21,7 @@
  */
 #include <cmath>
 #include <algorithm>
+#include <vector>
 
 #include "metric/ir/dcg.h"
 
@@ -30,6 +31,12 @@ namespace ir {
 
 const std::string Dcg::NAME_ = "DCG";
 
+void Dcg::precompute(PreparedDataset &pd) const {
+  pd.gains.resize(pd.num_instances);
+  for (size_t i = 0; i < pd.num_instances; ++i)
+    pd.gains[i] = pow(2.0, pd.labels[i]) - 1.0f;
+}
+
 MetricScore Dcg::compute_dcg(const Label *labels, size_t len) const {
   const size_t size = std::min(cutoff(), len);
   double dcg = 0.0;
@@ -45,15 +52,32 @@ MetricScore Dcg::evaluate_result_list(const quickrank::data::QueryResults *rl,
   if (size == 0)
     return 0.0;
 
-  // we have at most cutoff to be evaluated
-  Label *sorted_l = new Label[size];
-  rl->sorted_labels(scores, sorted_l, cutoff());
+  // we have at most cutoff to be ranked, per-thread buffer is reused
+  static thread_local std::vector<size_t> idx;
+  idx.resize(rl->num_results());
+  rl->indexing_of_sorted_labels(scores, idx.data(), size);
 
-  MetricScore dcg = compute_dcg(sorted_l, rl->num_results());
+  return Dcg::evaluate_ranked_list(rl, scores, idx.data());
+}
 
-  delete[] sorted_l;
+MetricScore Dcg::evaluate_ranked_list(const quickrank::data::QueryResults *rl,
+                                      const Score *scores,
+                                      const size_t *ranking) const {
+  const size_t size = std::min(cutoff(), rl->num_results());
 
-  return dcg;
+  // accumulate precomputed gains, if available
+  size_t q;
+  const PreparedDataset *pd = find_prepared(rl, q);
+  double dcg = 0.0;
+  if (pd && !pd->gains.empty()) {
+    const double *gains = pd->gains.data() + pd->offsets[q];
+    for (size_t i = 0; i < size; ++i)
+      dcg += gains[ranking[i]] / log2(i + 2.0f);
+  } else {
+    for (size_t i = 0; i < size; ++i)
+      dcg += (pow(2.0, rl->labels()[ranking[i]]) - 1.0f) / log2(i + 2.0f);
+  }
+  return (MetricScore) dcg;
 }
 
 std::unique_ptr<Jacobian> Dcg::jacobian(
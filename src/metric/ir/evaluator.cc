@@ -0,0 +1,101 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include <algorithm>
+
+#include "metric/ir/evaluator.h"
+
+namespace quickrank {
+namespace metric {
+namespace ir {
+
+Evaluator::Evaluator(std::vector<std::shared_ptr<Metric>> metrics)
+    : metrics_(metrics) {
+  max_cutoff_ = 0;
+  for (auto metric: metrics_)
+    max_cutoff_ = std::max(max_cutoff_, metric->cutoff());
+}
+
+void Evaluator::prepare(const std::shared_ptr<data::Dataset> dataset) {
+  for (auto metric: metrics_)
+    metric->prepare(dataset);
+}
+
+void Evaluator::prepare(const std::shared_ptr<data::VerticalDataset> dataset) {
+  for (auto metric: metrics_)
+    metric->prepare(dataset);
+}
+
+std::vector<MetricScore> Evaluator::evaluate_dataset(
+    const std::shared_ptr<data::Dataset> dataset, const Score *scores) const {
+  return evaluate(*dataset, scores);
+}
+
+std::vector<MetricScore> Evaluator::evaluate_dataset(
+    const std::shared_ptr<data::VerticalDataset> dataset,
+    const Score *scores) const {
+  return evaluate(*dataset, scores);
+}
+
+template<class D>
+std::vector<MetricScore> Evaluator::evaluate(const D &dataset,
+                                             const Score *scores) const {
+  const size_t num_queries = dataset.num_queries();
+  const size_t num_metrics = metrics_.size();
+  std::vector<MetricScore> query_scores(num_queries * num_metrics);
+
+  #pragma omp parallel for schedule(dynamic, 16)
+  for (size_t q = 0; q < num_queries; q++) {
+    data::QueryResults r = dataset.getQueryResultsView(q);
+    const Score *query_scores_p = scores + dataset.offset(q);
+
+    // rank the results once for all the metrics
+    static thread_local std::vector<size_t> idx;
+    idx.resize(r.num_results());
+    r.indexing_of_sorted_labels(query_scores_p, idx.data(),
+                                std::min(max_cutoff_, r.num_results()));
+
+    for (size_t m = 0; m < num_metrics; m++)
+      query_scores[q * num_metrics + m] = metrics_[m]->evaluate_ranked_list(
+          &r, query_scores_p, idx.data());
+  }
+
+  // sums are computed in query order, as in Metric::evaluate_dataset
+  std::vector<MetricScore> metric_scores(num_metrics);
+  for (size_t m = 0; m < num_metrics; m++) {
+    MetricScore sum = 0.0;
+    for (size_t q = 0; q < num_queries; q++)
+      sum += query_scores[q * num_metrics + m];
+    metric_scores[m] = metrics_[m]->dataset_score(sum, num_queries,
+                                                  dataset.num_instances());
+  }
+  return metric_scores;
+}
+
+std::ostream &Evaluator::put(std::ostream &os) const {
+  for (size_t m = 0; m < metrics_.size(); m++)
+    os << (m ? " " : "") << *metrics_[m];
+  return os;
+}
+
+}  // namespace ir
+}  // namespace metric
+}  // namespace quickrank
@@ -21,6 +21,7 @@
  */
 #include <cmath>
 #include <algorithm>
+#include <vector>
 
 #include "metric/ir/map.h"
 
@@ -30,54 +31,115 @@ namespace ir {
 
 const std::string Map::NAME_ = "MAP";
 
+namespace {
+
+/// Computes the changes of AP in closed form, by means of the prefix counts
+/// of relevant documents and of the prefix sums of their discounts.
+class MapSwapDeltas: public Metric::SwapDeltas {
+ public:
+  explicit MapSwapDeltas(const data::RankedResults *ranked)
+      : labels_(ranked->num_results()),
+        relcount_(ranked->num_results()),
+        discounts_(ranked->num_results() + 1) {
+    count_ = 0;
+    discounts_[0] = 0.0;
+    for (size_t i = 0; i < labels_.size(); ++i) {
+      labels_[i] = ranked->sorted_labels()[i] > 0.0f ? 1 : 0;  //relevant
+      count_ += labels_[i];
+      relcount_[i] = count_;
+      discounts_[i + 1] = discounts_[i] + labels_[i] / (i + 1.0);
+    }
+  }
+
+  virtual void row(size_t i, double *deltas) const {
+    for (size_t j = i + 1; j < labels_.size(); ++j) {
+      if (count_ == 0 || labels_[i] == labels_[j]) {
+        deltas[j] = 0.0;
+        continue;
+      }
+      // documents between i and j gain (or lose) one relevant above them
+      const int diff = labels_[j] - labels_[i];
+      MetricScore change = ((relcount_[i] + diff) * labels_[j]
+          - relcount_[i] * labels_[i]) / (i + 1.0);
+      change += diff * (discounts_[j] - discounts_[i + 1]);
+      change += (-relcount_[j] * diff) / (j + 1.0);
+      deltas[j] = change / count_;
+    }
+  }
+
+ private:
+  std::vector<int> labels_;
+  std::vector<int> relcount_;
+  /// discounts_[k] is the sum of 1/(r+1) for relevant ranks r < k.
+  std::vector<double> discounts_;
+  int count_;
+};
+
+}  // namespace
+
+void Map::precompute(PreparedDataset &pd) const {
+  const size_t num_queries = pd.offsets.size() - 1;
+  pd.query_values.resize(num_queries);
+  for (size_t q = 0; q < num_queries; ++q) {
+    size_t nrel = 0;
+    for (size_t i = pd.offsets[q]; i < pd.offsets[q + 1]; ++i)
+      if (pd.labels[i] > 0.0f)
+        nrel++;
+    pd.query_values[q] = nrel;
+  }
+}
+
 MetricScore Map::evaluate_result_list(const quickrank::data::QueryResults *rl,
                                       const Score *scores) const {
   size_t size = std::min(cutoff(), rl->num_results());
   if (size == 0)
     return 0.0;
 
+  // no relevant documents, no need to rank them
+  size_t q;
+  const PreparedDataset *pd = find_prepared(rl, q);
+  if (pd && pd->query_values[q] == 0)
+    return 0.0;
+
+  // only the top-size positions in score order are needed
+  static thread_local std::vector<size_t> idx;
+  idx.resize(rl->num_results());
+  rl->indexing_of_sorted_labels(scores, idx.data(), size);
+
+  return Map::evaluate_ranked_list(rl, scores, idx.data());
+}
+
+MetricScore Map::evaluate_ranked_list(const quickrank::data::QueryResults *rl,
+                                      const Score *scores,
+                                      const size_t *ranking) const {
+  size_t size = std::min(cutoff(), rl->num_results());
+
   MetricScore ap = 0.0f;
   MetricScore count = 0.0f;
   for (size_t i = 0; i < size; ++i)
-    if (rl->labels()[i] > 0.0f)
+    if (rl->labels()[ranking[i]] > 0.0f)
       ap += (++count) / (i + 1.0f);
   return count > 0 ? ap / count : 0.0;
 }
 
 std::unique_ptr<Jacobian> Map::jacobian(
     std::shared_ptr<data::RankedResults> ranked) const {
-  int *labels = new int[ranked->num_results()];  // int labels[ql.size];
-  int *relcount = new int[ranked->num_results()];  // int relcount[ql.size];
-  MetricScore count = 0;
-  for (size_t i = 0; i < ranked->num_results(); ++i) {
-    if (ranked->sorted_labels()[i] > 0.0f)  //relevant if true
-      labels[i] = 1, ++count;
-    else
-      labels[i] = 0;
-    relcount[i] = count;
-  }
-  // count = (ql.qid<nrelevantdocs && relevantdocs[ql.qid]>count) ? relevantdocs[ql.qid] : count;
+  const size_t size = ranked->num_results();
   std::unique_ptr<Jacobian> changes = std::unique_ptr<Jacobian>(
-      new Jacobian(ranked->num_results()));
-  if (count != 0) {
-#pragma omp parallel for
-    for (size_t i = 0; i < ranked->num_results() - 1; ++i)
-      for (size_t j = i + 1; j < ranked->num_results(); ++j)
-        if (labels[i] != labels[j]) {
-          const int diff = labels[j] - labels[i];
-          MetricScore change = ((relcount[i] + diff) * labels[j]
-              - relcount[i] * labels[i]) / (i + 1.0f);
-          for (size_t k = i + 1; k < j; ++k)
-            if (labels[k] > 0)
-              change += (relcount[k] + diff) / (k + 1.0f);
-          change += (-relcount[j] * diff) / (j + 1.0f);
-          changes->at(i, j) = change / count;
-        }
+      new Jacobian(size));
+
+  MapSwapDeltas swap_deltas(ranked.get());
+  std::vector<double> deltas(size);
+  for (size_t i = 0; i + 1 < size; ++i) {
+    swap_deltas.row(i, deltas.data());
+    std::copy(deltas.begin() + i + 1, deltas.end(), changes->vectat(i, i + 1));
   }
-  delete[] labels;
-  delete[] relcount;
   return changes;
+}
 
+std::unique_ptr<Metric::SwapDeltas> Map::swap_deltas(
+    std::shared_ptr<data::RankedResults> ranked) const {
+  return std::unique_ptr<SwapDeltas>(new MapSwapDeltas(ranked.get()));
 }
 
 std::ostream &Map::put(std::ostream &os) const {
@@ -0,0 +1,117 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include <algorithm>
+
+#include "metric/ir/metric.h"
+
+namespace quickrank {
+namespace metric {
+namespace ir {
+
+namespace {
+
+/// Swap deltas read from a materialized Jacobian matrix.
+class JacobianSwapDeltas: public Metric::SwapDeltas {
+ public:
+  JacobianSwapDeltas(std::unique_ptr<Jacobian> jacobian, size_t num_results)
+      : jacobian_(std::move(jacobian)), num_results_(num_results) {
+  }
+
+  virtual void row(size_t i, double *deltas) const {
+    // elements j > i of a row are stored contiguously
+    if (i + 1 < num_results_) {
+      const double *p_jacobian = jacobian_->vectat(i, i + 1);
+      std::copy(p_jacobian, p_jacobian + num_results_ - i - 1, deltas + i + 1);
+    }
+  }
+
+ private:
+  std::unique_ptr<Jacobian> jacobian_;
+  size_t num_results_;
+};
+
+}  // namespace
+
+std::unique_ptr<Metric::SwapDeltas> Metric::swap_deltas(
+    std::shared_ptr<data::RankedResults> ranked) const {
+  return std::unique_ptr<SwapDeltas>(
+      new JacobianSwapDeltas(jacobian(ranked), ranked->num_results()));
+}
+
+void Metric::prepare(const std::shared_ptr<data::Dataset> dataset) {
+  prepare_dataset(dataset);
+}
+
+void Metric::prepare(const std::shared_ptr<data::VerticalDataset> dataset) {
+  prepare_dataset(dataset);
+}
+
+template<class D>
+void Metric::prepare_dataset(const std::shared_ptr<D> dataset) {
+  // discard data of released datasets and of the given one
+  for (size_t i = 0; i < prepared_.size();) {
+    auto prepared_ds = prepared_[i]->dataset.lock();
+    if (!prepared_ds || prepared_ds == dataset)
+      prepared_.erase(prepared_.begin() + i);
+    else
+      i++;
+  }
+
+  if (!dataset || dataset->num_queries() == 0)
+    return;
+
+  auto pd = std::make_shared<PreparedDataset>();
+  pd->dataset = dataset;
+  pd->labels = dataset->getQueryResultsView(0).labels();
+  pd->num_instances = dataset->num_instances();
+  pd->cutoff = cutoff();
+  pd->offsets.resize(dataset->num_queries() + 1);
+  for (size_t q = 0; q <= dataset->num_queries(); q++)
+    pd->offsets[q] = dataset->offset(q);
+
+  precompute(*pd);
+  prepared_.push_back(pd);
+}
+
+const Metric::PreparedDataset *Metric::find_prepared(
+    const data::QueryResults *rl, size_t &q) const {
+  for (const auto &pd : prepared_) {
+    if (pd->cutoff != cutoff() || pd->dataset.expired())
+      continue;
+    if (rl->labels() < pd->labels
+        || rl->labels() >= pd->labels + pd->num_instances)
+      continue;
+
+    // the last query starting at the given offset (previous ones are empty)
+    const size_t offset = rl->labels() - pd->labels;
+    auto it = std::upper_bound(pd->offsets.begin(), pd->offsets.end(), offset);
+    q = it - pd->offsets.begin() - 1;
+    if (pd->offsets[q] == offset
+        && pd->offsets[q + 1] - offset == rl->num_results())
+      return pd.get();
+  }
+  return NULL;
+}
+
+}  // namespace ir
+}  // namespace metric
+}  // namespace quickrank
@@ -21,6 +21,7 @@
  */
 #include <cmath>
 #include <algorithm>
+#include <vector>
 
 #include <cstring>
 
@@ -32,17 +33,32 @@ namespace ir {
 
 const std::string Ndcg::NAME_ = "NDCG";
 
+void Ndcg::precompute(PreparedDataset &pd) const {
+  Dcg::precompute(pd);
+
+  const size_t num_queries = pd.offsets.size() - 1;
+  pd.query_values.resize(num_queries);
+  for (size_t q = 0; q < num_queries; ++q) {
+    data::QueryResults rl(pd.offsets[q + 1] - pd.offsets[q],
+                          const_cast<Label *>(pd.labels) + pd.offsets[q],
+                          NULL);
+    pd.query_values[q] = compute_idcg(&rl);
+  }
+}
+
 MetricScore Ndcg::compute_idcg(const quickrank::data::QueryResults *rl) const {
-  //make a copy of labels
-  Label *copyoflabels = new Label[rl->num_results()];
-  memcpy(copyoflabels, rl->labels(), sizeof(Label) * rl->num_results());
+  size_t q;
+  const PreparedDataset *pd = find_prepared(rl, q);
+  if (pd && !pd->query_values.empty())
+    return pd->query_values[q];
+
+  //make a copy of labels in a per-thread buffer
+  static thread_local std::vector<Label> copyoflabels;
+  copyoflabels.assign(rl->labels(), rl->labels() + rl->num_results());
   //sort the copy
-  std::sort(copyoflabels, copyoflabels + rl->num_results(),
-            std::greater<int>());
+  std::sort(copyoflabels.begin(), copyoflabels.end(), std::greater<int>());
   //compute dcg
-  MetricScore dcg = compute_dcg(copyoflabels, rl->num_results());
-
-  delete[] copyoflabels;
+  MetricScore dcg = compute_dcg(copyoflabels.data(), rl->num_results());
   return dcg;
 }
 
@@ -57,15 +73,24 @@ MetricScore Ndcg::evaluate_result_list(const quickrank::data::QueryResults *rl,
     return 0;
 }
 
+MetricScore Ndcg::evaluate_ranked_list(const quickrank::data::QueryResults *rl,
+                                       const Score *scores,
+                                       const size_t *ranking) const {
+  if (rl->num_results() == 0)
+    return 0.0;
+  const MetricScore idcg = Ndcg::compute_idcg(rl);
+  if (idcg > 0)
+    return Dcg::evaluate_ranked_list(rl, scores, ranking) / idcg;
+  else
+    return 0;
+}
+
 std::unique_ptr<Jacobian> Ndcg::jacobian(
     std::shared_ptr<data::RankedResults> ranked) const {
   std::unique_ptr<Jacobian> jacobian = std::unique_ptr<Jacobian>(
       new Jacobian(ranked->num_results()));
 
-  auto results = std::shared_ptr<data::QueryResults>(
-      new data::QueryResults(ranked->num_results(), ranked->sorted_labels(),
-                             NULL));
-  const double idcg = compute_idcg(results.get());
+  const double idcg = compute_idcg(ranked->query_results().get());
   if (idcg <= 0.0)
     return jacobian;
 
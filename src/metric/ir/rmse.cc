@@ -42,39 +42,11 @@ MetricScore Rmse::evaluate_result_list(const quickrank::data::QueryResults *rl,
   return sse;
 }
 
-MetricScore Rmse::evaluate_dataset(
-    const std::shared_ptr<data::Dataset> dataset, const Score *scores) const {
-
-  size_t size = std::min(cutoff(), (size_t) dataset->num_queries());
-  if (size == 0)
+MetricScore Rmse::dataset_score(MetricScore sum, size_t num_queries,
+                                size_t num_instances) const {
+  if (num_queries == 0)
     return 0.0;
-
-  MetricScore sse = 0.0f;
-  for (size_t q = 0; q < dataset->num_queries(); q++) {
-    std::shared_ptr<data::QueryResults> r = dataset->getQueryResults(q);
-    sse += evaluate_result_list(r.get(), scores);
-    scores += r->num_results();
-  }
-
-  return -sqrt(sse / dataset->num_instances());
-}
-
-MetricScore Rmse::evaluate_dataset(
-    const std::shared_ptr<data::VerticalDataset> dataset,
-    const Score *scores) const {
-
-  size_t size = std::min(cutoff(), (size_t) dataset->num_queries());
-  if (size == 0)
-    return 0.0;
-
-  MetricScore sse = 0.0f;
-  for (size_t q = 0; q < dataset->num_queries(); q++) {
-    std::shared_ptr<data::QueryResults> r = dataset->getQueryResults(q);
-    sse += evaluate_result_list(r.get(), scores);
-    scores += r->num_results();
-  }
-
-  return -sqrt(sse / dataset->num_instances());
+  return -sqrt(sum / num_instances);
 }
 
 std::unique_ptr<Jacobian> Rmse::jacobian(
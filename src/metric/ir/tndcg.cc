@@ -21,6 +21,7 @@
  */
 #include <cmath>
 #include <algorithm>
+#include <vector>
 
 #include "metric/ir/tndcg.h"
 
@@ -30,16 +31,80 @@ namespace ir {
 
 const std::string Tndcg::NAME_ = "TNDCG";
 
+namespace {
+
+/// Computes the changes of TNDCG from the per-rank discount weights,
+/// averaged over groups of tied scores, and the per-rank gains.
+class TndcgSwapDeltas: public Metric::SwapDeltas {
+ public:
+  TndcgSwapDeltas(std::shared_ptr<data::RankedResults> ranked, double idcg,
+                  size_t cutoff)
+      : ranked_(ranked),
+        weights_(ranked->num_results(), 0.0),
+        gains_(ranked->num_results()),
+        labels_(ranked->sorted_labels()) {
+    const size_t num_results = ranked->num_results();
+    size_ = std::min(cutoff, num_results);
+    if (idcg <= 0.0) {
+      size_ = 0;
+      return;
+    }
+
+    for (size_t i = 0; i < num_results;) {
+      // find how many with the same score
+      // and compute avg discount
+      size_t j = i + 1;
+      while (j < num_results
+          && ranked->sorted_scores()[i] == ranked->sorted_scores()[j])
+        j++;
+
+      for (size_t k = i; k < j; k++)
+        weights_[i] += (1.0 / log2(k + 2.0f));
+      double tie_size = (double) (j - i);
+      weights_[i] /= tie_size;     // divide by tie size
+      weights_[i] /= idcg;         // divide now by idcg to save future operations
+      for (size_t k = i + 1; k < j; k++)
+        weights_[k] = weights_[i];  // copy for ties
+      i = j;
+    }
+
+    for (size_t i = 0; i < num_results; ++i)
+      gains_[i] = pow(2.0, labels_[i]);
+  }
+
+  virtual void row(size_t i, double *deltas) const {
+    const size_t num_results = weights_.size();
+    for (size_t j = i + 1; j < num_results; ++j) {
+      // if the label is the same, or both are beyond the cutoff,
+      // no changes occur
+      if (i >= size_ || labels_[i] == labels_[j])
+        deltas[j] = 0.0;
+      else if (j < size_)
+        deltas[j] = (weights_[j] - weights_[i]) * (gains_[i] - gains_[j]);
+      else
+        deltas[j] = weights_[i] * (gains_[j] - gains_[i]);
+    }
+  }
+
+ private:
+  std::shared_ptr<data::RankedResults> ranked_;
+  std::vector<double> weights_;
+  std::vector<double> gains_;
+  const Label *labels_;
+  size_t size_;
+};
+
+}  // namespace
+
 MetricScore Tndcg::compute_tndcg(const quickrank::data::QueryResults *rl,
-                                 const Score *scores) const {
+                                 const Score *scores,
+                                 const size_t *idx) const {
   const double idcg = Ndcg::compute_idcg(rl);
   if (idcg <= 0.0)
     return 0;
 
-  size_t *idx = new size_t[rl->num_results()];
-  rl->indexing_of_sorted_labels(scores, idx);
-
   const size_t size = std::min(cutoff(), rl->num_results());
+
   double tndcg = 0.0;
 
   for (size_t i = 0; i < size;) {
@@ -58,7 +123,6 @@ MetricScore Tndcg::compute_tndcg(const quickrank::data::QueryResults *rl,
     i = j;
   }
 
-  delete[] idx;
   return (MetricScore) (tndcg / idcg);
 }
 
@@ -67,69 +131,49 @@ MetricScore Tndcg::evaluate_result_list(const quickrank::data::QueryResults *rl,
   if (rl->num_results() == 0)
     return 0.0;
 
-  MetricScore tndcg = compute_tndcg(rl, scores);
+  // only the top-size positions are sorted, documents in the tail
+  // tied with the last one of the head follow it
+  static thread_local std::vector<size_t> idx;
+  idx.resize(rl->num_results());
+  rl->indexing_of_sorted_labels(scores, idx.data(),
+                                std::min(cutoff(), rl->num_results()));
 
-  return tndcg;
+  return compute_tndcg(rl, scores, idx.data());
+}
+
+MetricScore Tndcg::evaluate_ranked_list(
+    const quickrank::data::QueryResults *rl, const Score *scores,
+    const size_t *ranking) const {
+  if (rl->num_results() == 0)
+    return 0.0;
+
+  return compute_tndcg(rl, scores, ranking);
 }
 
 std::unique_ptr<Jacobian> Tndcg::jacobian(
     std::shared_ptr<data::RankedResults> ranked) const {
+  const size_t num_results = ranked->num_results();
   std::unique_ptr<Jacobian> jacobian = std::unique_ptr<Jacobian>(
-      new Jacobian(ranked->num_results()));
-
-  auto _results = std::shared_ptr<data::QueryResults>(
-      new data::QueryResults(ranked->num_results(), ranked->sorted_labels(),
-                             NULL));
-  const double idcg = compute_idcg(_results.get());
-  if (idcg <= 0.0)
-    return jacobian;
-
-  const size_t size = std::min(cutoff(), ranked->num_results());
-
-  double *weights = new double[ranked->num_results()]();  // init with 0s
-
-  /// \todo TODO: it makes sense to pre-compute weights also in ndcg
-  for (size_t i = 0; i < ranked->num_results();) {
-    // find how many with the same score
-    // and compute avg score
-    size_t j = i + 1;
-    while (j < ranked->num_results()
-        && ranked->sorted_scores()[i] == ranked->sorted_scores()[j])
-      j++;
-
-    for (size_t k = i; k < j; k++)
-      weights[i] += (1.0 / log2(k + 2.0f));
-    double tie_size = (double) (j - i);
-    weights[i] /= tie_size;     // divide by tie size
-    weights[i] /= idcg;         // divide now by idcg to save future operations
-    for (size_t k = i + 1; k < j; k++)
-      weights[k] = weights[i];  // copy for ties
-    i = j;
-  }
-
-  /// \todo TODO: jacobian->at is expensive, we should do this in the results list order
-  /// and not in the re-sorted list
-  for (size_t i = 0; i < size; ++i) {
-    for (size_t j = i + 1; j < ranked->num_results(); ++j) {
-      // if the score is the same, non changes occur
-      if (ranked->sorted_labels()[i] != ranked->sorted_labels()[j]) {
-        if (j < size)
-          jacobian->at(i, j) =
-          jacobian->at(i, j) = (weights[j] - weights[i]) *
-              ( pow(2.0, ranked->sorted_labels()[i])
-              - pow(2.0, ranked->sorted_labels()[j]) );
-        else
-          jacobian->at(i, j) = weights[i] *
-              ( pow(2.0, ranked->sorted_labels()[j])
-                  - pow(2.0, ranked->sorted_labels()[i]) );
-      }
-    }
+      new Jacobian(num_results));
+
+  std::unique_ptr<SwapDeltas> swap_deltas = Tndcg::swap_deltas(ranked);
+  std::vector<double> deltas(num_results);
+  const size_t size = std::min(cutoff(), num_results);
+  for (size_t i = 0; i < size && i + 1 < num_results; ++i) {
+    swap_deltas->row(i, deltas.data());
+    std::copy(deltas.begin() + i + 1, deltas.end(),
+              jacobian->vectat(i, i + 1));
   }
-
-  delete[] weights;
   return jacobian;
 }
 
+std::unique_ptr<Metric::SwapDeltas> Tndcg::swap_deltas(
+    std::shared_ptr<data::RankedResults> ranked) const {
+  const double idcg = compute_idcg(ranked->query_results().get());
+  return std::unique_ptr<SwapDeltas>(
+      new TndcgSwapDeltas(ranked, idcg, cutoff()));
+}
+
 std::ostream &Tndcg::put(std::ostream &os) const {
   if (cutoff() != Metric::NO_CUTOFF)
     return os << name() << "@" << cutoff();
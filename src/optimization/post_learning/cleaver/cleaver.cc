@@ -41,6 +41,8 @@ namespace pruning {
 
 const std::string Cleaver::NAME_ = "CLEAVER";
 
+const size_t Cleaver::CANDIDATES_BLOCK_SIZE = 16;
+
 const std::vector<std::string> Cleaver::pruningMethodNames = {
     "RANDOM", "RANDOM_ADV", "LOW_WEIGHTS", "SKIP", "LAST",
     "QUALITY_LOSS", "QUALITY_LOSS_ADV", "SCORE_LOSS"
@@ -55,28 +55,50 @@ void QualityLossAdvPruning::pruning(std::set<unsigned int> &pruned_estimators,
 
   Feature *features = dataset->at(0, 0);
 
-  std::vector<Score> new_dataset_score(dataset->num_instances(), 0);
-  for (unsigned int p = 0; p < estimators_to_prune_; ++p) {
+  // Candidate removals are evaluated in blocks, each one with a single pass
+  // over the dataset
+  const size_t num_instances = dataset->num_instances();
+  std::vector<Score> new_dataset_score(num_instances * CANDIDATES_BLOCK_SIZE);
+  std::vector<size_t> candidates;
+  candidates.reserve(CANDIDATES_BLOCK_SIZE);
 
-    #pragma omp parallel for firstprivate(new_dataset_score)
-    for (size_t f = start_last; f < num_features; ++f) {
+  for (unsigned int p = 0; p < estimators_to_prune_; ++p) {
 
-      if (pruned_estimators.count(f)) {
-        metric_scores[f - start_last] = std::numeric_limits<double>::lowest();
-        continue;
+    size_t f = start_last;
+    while (f < num_features) {
+
+      // collects the next block of estimators not pruned yet
+      candidates.clear();
+      for (; f < num_features && candidates.size() < CANDIDATES_BLOCK_SIZE;
+           ++f) {
+        if (pruned_estimators.count(f))
+          metric_scores[f - start_last] =
+              std::numeric_limits<double>::lowest();
+        else
+          candidates.push_back(f);
       }
+      if (candidates.empty())
+        continue;
 
-      // In place of set the feature weight to 0, score the dataset with the
-      // Cleaver score function, and reset back the weight, we optimize the
-      // process by computing on the fly the new score based on the original
-      // score less the contribute given by the f-th feature...
-      for (unsigned int s = 0; s < dataset->num_instances(); ++s) {
-        new_dataset_score[s] = dataset_score[s] -
-            weights_[f] * features[s * num_features + f];
+      #pragma omp parallel for
+      for (size_t c = 0; c < candidates.size(); ++c) {
+        // In place of set the feature weight to 0, score the dataset with the
+        // Cleaver score function, and reset back the weight, we optimize the
+        // process by computing on the fly the new score based on the original
+        // score less the contribute given by the c-th candidate feature...
+        const size_t cf = candidates[c];
+        Score *candidate_score = &new_dataset_score[c * num_instances];
+        for (unsigned int s = 0; s < num_instances; ++s) {
+          candidate_score[s] = dataset_score[s] -
+              weights_[cf] * features[s * num_features + cf];
+        }
       }
 
-      metric_scores[f - start_last] =
-          scorer->evaluate_dataset(dataset, &new_dataset_score[0]);
+      std::vector<MetricScore> block_scores(candidates.size());
+      scorer->evaluate_dataset_batch(dataset, &new_dataset_score[0],
+                                     candidates.size(), &block_scores[0]);
+      for (size_t c = 0; c < candidates.size(); ++c)
+        metric_scores[candidates[c] - start_last] = block_scores[c];
     }
 
     auto max = std::max_element(metric_scores.cbegin(), metric_scores.cend());
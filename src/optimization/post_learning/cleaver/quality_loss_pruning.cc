@@ -55,22 +55,31 @@ void QualityLossPruning::pruning(std::set<unsigned int> &pruned_estimators,
 
   Feature *features = dataset->at(0, 0);
 
-  std::vector<Score> new_dataset_score(dataset->num_instances(), 0);
-
-  #pragma omp parallel for firstprivate(new_dataset_score)
-  for (size_t f = start_last; f < num_features; ++f) {
-
-    // In place of set the feature weight to 0, score the dataset with the
-    // Cleaver score function, and reset back the weight, we optimize the
-    // process by computing on the fly the new score based on the original
-    // score less the contribute given by the f-th feature...
-    for (unsigned int s = 0; s < dataset->num_instances(); ++s) {
-      new_dataset_score[s] = dataset_score[s] -
-          weights_[f] * features[s * num_features + f];
+  // Candidate removals are evaluated in blocks, each one with a single pass
+  // over the dataset
+  const size_t num_instances = dataset->num_instances();
+  std::vector<Score> new_dataset_score(num_instances * CANDIDATES_BLOCK_SIZE);
+
+  for (size_t b = start_last; b < num_features; b += CANDIDATES_BLOCK_SIZE) {
+    const size_t block_end = std::min(b + CANDIDATES_BLOCK_SIZE, num_features);
+
+    #pragma omp parallel for
+    for (size_t f = b; f < block_end; ++f) {
+
+      // In place of set the feature weight to 0, score the dataset with the
+      // Cleaver score function, and reset back the weight, we optimize the
+      // process by computing on the fly the new score based on the original
+      // score less the contribute given by the f-th feature...
+      Score *candidate_score = &new_dataset_score[(f - b) * num_instances];
+      for (unsigned int s = 0; s < num_instances; ++s) {
+        candidate_score[s] = dataset_score[s] -
+            weights_[f] * features[s * num_features + f];
+      }
     }
 
-    metric_scores[f - start_last] =
-        scorer->evaluate_dataset(dataset, &new_dataset_score[0]);
+    scorer->evaluate_dataset_batch(dataset, &new_dataset_score[0],
+                                   block_end - b,
+                                   &metric_scores[b - start_last]);
   }
 
   // Find the last metric scores
@@ -57,6 +57,8 @@
 #include "metric/ir/map.h"
 #include "metric/ir/rmse.h"
 
+#include "scoring/scoring_engine_factory.h"
+
 #include "driver/driver.h"
 
 void print_logo() {
@@ -169,20 +171,33 @@ int main(int argc, char *argv[]) {
                         train_cutoff);
 
   pmap.addOptionWithArg("partial",
-                        {"set partial file save frequency."},
+                        {"set partial file save frequency",
+                         "(trees are appended to the <model-out>.ckpt log "
+                         "for MART-based models)."},
                         partial_save);
 
   pmap.addOptionWithArg<std::string>("train", {"set training file."});
 
   pmap.addOptionWithArg<std::string>("valid", {"set validation file."});
 
+  pmap.addOptionWithArg<std::string>("valid-metrics",
+                                     {"set additional validation metrics",
+                                      "(e.g., NDCG@10,MAP) [applies only to MART-based models]."});
+
   pmap.addOptionWithArg<std::string>("features", {"set features file."});
 
   pmap.addOptionWithArg<std::string>("model-in",
                                      {"set input model file",
                                      "(for testing, re-training or optimization)"});
   pmap.addOptionWithArg<std::string>("model-out",
-                                     {"set output model file"});
+                                     {"set output model file",
+                                      "(the input model is converted when "
+                                      "not trained)"});
+  pmap.addOptionWithArg("model-format",
+                        {"set output model format. Allowed options are:",
+                         "-  \"xml\",",
+                         "-  \"binary\" (mapped in memory when loaded)."},
+                        std::string("xml"));
   pmap.addOption("skip-train", {"skip training phase."});
   pmap.addOption("restart-train", {"restart training phase from a previous "
                                        "trained model."});
@@ -400,6 +415,10 @@ int main(int argc, char *argv[]) {
                         {"set test metric cutoff."},
                         test_cutoff);
 
+  pmap.addOptionWithArg<std::string>("test-metrics",
+                                     {"set additional test metrics",
+                                      "(e.g., NDCG@10,MAP,TNDCG@5)."});
+
   pmap.addOptionWithArg<std::string>("test", {"set testing file."});
 
   pmap.addOptionWithArg<std::string>("scores", {"set output scores file."});
@@ -407,6 +426,27 @@ int main(int argc, char *argv[]) {
   pmap.addOption("detailed",
                  {"enable detailed testing [applies only to ensemble models]."});
 
+  std::string scoringEngines = "";
+  for (auto i: quickrank::scoring::scoringEngineNames)
+    scoringEngines += i + "|";
+  scoringEngines = scoringEngines.substr(0, scoringEngines.size() - 1);
+
+  pmap.addOptionWithArg<std::string>("engine",
+                                     {"set scoring engine:",
+                                      "[" + scoringEngines + "]."});
+
+  pmap.addOptionWithArg<size_t>("trees-block-size",
+                                {"set number of trees in each block",
+                                 "[applies only to block-wise engines]",
+                                 "(0 means sized according to caches)."},
+                                0);
+
+  pmap.addOptionWithArg<size_t>("docs-block-size",
+                                {"set number of documents in each batch",
+                                 "[applies only to block-wise engines]",
+                                 "(0 means sized according to caches)."},
+                                0);
+
 
   // --------------------------------------------------------
   pmap.addMessage({"Code generation - general options:"});
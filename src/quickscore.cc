@@ -19,16 +19,39 @@
  * Contributor:
  *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
  */
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <iostream>
 #include <fstream>
 #include <iomanip>
 #include <chrono>
+#include <limits>
+#include <pthread.h>
+#include <signal.h>
+#include <sstream>
+#include <thread>
+#include <stdint.h>
 #include <vector>
 
+#ifdef _OPENMP
+#include <omp.h>
+#else
+#include "utils/omp-stubs.h"
+#endif
+
 #include "paramsmap/paramsmap.h"
 
 #include "data/dataset.h"
 #include "io/svml.h"
+#include "learning/forests/mart.h"
+#include "learning/ltr_algorithm.h"
+#include "scoring/scoring_engine_factory.h"
+#include "scoring/anytime_engine.h"
+#include "scoring/cascade_engine.h"
+#include "scoring/quickscorer.h"
+#include "scoring/score_server.h"
+#include "utils/perf_counters.h"
 
 void print_logo() {
   if (isatty(fileno(stdout))) {
@@ -61,9 +84,254 @@ void print_logo() {
 
 double ranker(float *v);
 
-int main(int argc, char *argv[]) {
-  print_logo();
+/// Scores documents with the ranker compiled into quickscore.
+class CompiledRanker: public quickrank::scoring::ScoringEngine {
+ public:
+  virtual std::string name() const {
+    return "COMPILED";
+  }
+
+  virtual quickrank::Score score_document(const quickrank::Feature *d) const {
+    return ranker(const_cast<quickrank::Feature *>(d));
+  }
+
+  virtual void score_documents(const quickrank::Feature *d,
+                               size_t num_documents, size_t stride,
+                               quickrank::Score *scores) const {
+    for (size_t i = 0; i < num_documents; ++i)
+      scores[i] = ranker(const_cast<quickrank::Feature *>(d + i * stride));
+  }
+};
+
+/// Cutoff of the NDCG of the quality-vs-budget curve of anytime scoring.
+const size_t ANYTIME_CURVE_CUTOFF = 10;
+
+/// Latency percentiles, in microseconds.
+struct Percentiles {
+  double p50;
+  double p99;
+  double p999;
+};
+
+/// Computes the nearest-rank percentiles of the given latencies.
+Percentiles percentiles(std::vector<double> &latencies) {
+  Percentiles p = {0.0, 0.0, 0.0};
+  if (latencies.empty())
+    return p;
+  std::sort(latencies.begin(), latencies.end());
+  auto rank = [&latencies](double q) {
+    size_t r = (size_t) std::ceil(q * latencies.size());
+    return latencies[r > 0 ? r - 1 : 0] * 1e6;
+  };
+  p.p50 = rank(0.50);
+  p.p99 = rank(0.99);
+  p.p999 = rank(0.999);
+  return p;
+}
+
+double elapsed(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::duration<double>>(
+      std::chrono::steady_clock::now() - start).count();
+}
+
+/// Returns the FNV-1a hash of the bit patterns of the scores.
+uint64_t checksum(const std::vector<double> &scores) {
+  uint64_t hash = 14695981039346656037ULL;
+  const unsigned char *bytes = (const unsigned char *) scores.data();
+  for (size_t i = 0; i < scores.size() * sizeof(double); ++i) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+/// Returns the given string as a JSON string literal.
+std::string json_string(const std::string &str) {
+  std::string json = "\"";
+  for (char c: str) {
+    if (c == '"' || c == '\\')
+      json += '\\';
+    json += c;
+  }
+  return json + "\"";
+}
+
+std::ostream &operator<<(std::ostream &os, const Percentiles &p) {
+  return os << "{\"p50\": " << p.p50 << ", \"p99\": " << p.p99
+            << ", \"p999\": " << p.p999 << "}";
+}
+
+/// Serves the scoring requests sent to the given socket, or to the standard
+/// input if \a socket is "-", until they are closed. If \a model_file is not
+/// empty, the model is reloaded from it on SIGHUP.
+int serve(std::shared_ptr<quickrank::scoring::ScoringEngine> engine,
+          const std::string &socket, size_t num_features, size_t threads,
+          const std::string &model_file, const std::string &engine_name,
+          size_t trees_block_size, size_t documents_block_size) {
+  // the handle holds the only reference, so that reloads free the engine
+  auto model =
+      std::make_shared<quickrank::scoring::ModelHandle>(std::move(engine));
+  quickrank::scoring::ScoreServer server(model, num_features);
+
+  // SIGHUP is blocked in all the threads but the one reloading the model
+  sigset_t reload_signals;
+  sigemptyset(&reload_signals);
+  sigaddset(&reload_signals, SIGHUP);
+  pthread_sigmask(SIG_BLOCK, &reload_signals, NULL);
+  std::atomic<bool> serving(true);
+  std::thread reloader([&]() {
+    int signal;
+    while (sigwait(&reload_signals, &signal) == 0 && serving) {
+      if (model_file.empty())
+        continue;
+      auto start = std::chrono::steady_clock::now();
+      model->reload(model_file, engine_name, num_features, trees_block_size,
+                    documents_block_size);
+      if (model->wait())
+        std::cout << "# Model reloaded from " << model_file << " in "
+                  << elapsed(start) << " s." << std::endl;
+      else
+        std::cerr << " !! Model was not reloaded properly" << std::endl;
+    }
+  });
+
+  if (socket == "-") {
+    std::cout << "# Serving on the standard input" << std::endl;
+    if (!server.serve_stream(fileno(stdin), fileno(stdout)))
+      std::cerr << " !! Request was not well formed" << std::endl;
+  } else {
+    std::cout << "# Serving on " << socket << " with " << threads
+              << " threads" << std::endl;
+    server.serve_socket(socket, threads);
+  }
+
+  serving = false;
+  pthread_kill(reloader.native_handle(), SIGHUP);
+  reloader.join();
+
+  std::vector<double> latencies = server.latencies();
+  Percentiles latency = percentiles(latencies);
+  std::cout << std::setprecision(3);
+  std::cout << "       Served requests: " << server.num_requests()
+            << " (" << server.num_documents() << " documents)" << std::endl;
+  std::cout << "Latency p50/p99/p999: " << latency.p50 << " / "
+            << latency.p99 << " / " << latency.p999 << " us." << std::endl;
+  return EXIT_SUCCESS;
+}
+
+/// Sends the queries of the given dataset to the server listening on the
+/// given socket, from \a threads connections at once, and measures the
+/// latencies and the throughput seen by clients.
+int generate_load(const std::string &socket, const std::string &dataset_file,
+                  size_t rounds, size_t warmup, size_t threads, size_t top_k,
+                  const std::string &scores_file) {
+  quickrank::io::Svml reader;
+  auto dataset = reader.read_horizontal(dataset_file);
+  std::cout << *dataset;
+
+  const size_t num_documents = dataset->num_instances();
+  const size_t num_features = dataset->num_features();
+  const size_t num_queries = dataset->num_queries();
+  std::vector<double> scores(num_documents);
+  std::vector<std::vector<double>> latencies(threads);
+  // the start of the requests of the timed rounds and their documents
+  std::vector<std::vector<std::pair<std::chrono::steady_clock::time_point,
+                                    size_t>>> requests(threads);
+  std::vector<std::chrono::steady_clock::time_point> warmed_up(threads);
+  // not a vector<bool>, which clients could not write concurrently
+  std::vector<char> failed(threads, false);
+
+  // a broken connection is reported as a failed request
+  signal(SIGPIPE, SIG_IGN);
+
+  // each connection sends every threads-th query
+  std::vector<std::thread> clients;
+  for (size_t c = 0; c < threads; ++c)
+    clients.push_back(std::thread([&, c]() {
+      quickrank::scoring::ScoreClient client(socket);
+      std::vector<quickrank::Score> query_scores;
+      std::vector<uint32_t> top;
+      warmed_up[c] = std::chrono::steady_clock::now();
+      for (size_t r = 0; r < warmup + rounds && client.is_connected(); ++r) {
+        if (r == warmup)
+          warmed_up[c] = std::chrono::steady_clock::now();
+        for (size_t q = c; q < num_queries; q += threads) {
+          const size_t offset = dataset->offset(q);
+          auto request_start = std::chrono::steady_clock::now();
+          if (client.score(dataset->at(offset, 0),
+                           dataset->offset(q + 1) - offset, num_features,
+                           top_k, query_scores, top)
+              != quickrank::scoring::ScoreServer::STATUS_OK) {
+            failed[c] = true;
+            return;
+          }
+          if (r >= warmup) {
+            latencies[c].push_back(elapsed(request_start));
+            requests[c].push_back(std::make_pair(
+                request_start, dataset->offset(q + 1) - offset));
+          }
+          if (top_k == 0)
+            std::copy(query_scores.begin(), query_scores.end(),
+                      scores.begin() + offset);
+        }
+      }
+      failed[c] = !client.is_connected();
+    }));
+  for (auto &client: clients)
+    client.join();
+
+  // the throughput is measured from the end of the last warm-up, counting
+  // only the requests sent since then, all of them of timed rounds: clients
+  // do not wait for each other, as they may be queued by a server with
+  // fewer threads than connections
+  auto start = *std::max_element(warmed_up.begin(), warmed_up.end());
+  double time = elapsed(start);
+  size_t timed_queries = 0;
+  size_t timed_documents = 0;
+  for (auto &client_requests: requests)
+    for (auto &request: client_requests)
+      if (request.first >= start) {
+        ++timed_queries;
+        timed_documents += request.second;
+      }
+
+  if (std::find(failed.begin(), failed.end(), true) != failed.end()) {
+    std::cerr << " !! Requests to " << socket << " failed" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::vector<double> all_latencies;
+  for (auto &l: latencies)
+    all_latencies.insert(all_latencies.end(), l.begin(), l.end());
+  Percentiles latency = percentiles(all_latencies);
+
+  std::cout << std::setprecision(3);
+  std::cout << "   Request latency p50/p99/p999: " << latency.p50 << " / "
+            << latency.p99 << " / " << latency.p999 << " us." << std::endl;
+  std::cout << "Throughput with " << std::setw(3) << threads
+            << " connections: "
+            << timed_documents / time << " docs/s, "
+            << timed_queries / time << " queries/s."
+            << std::endl;
+  if (top_k == 0) {
+    std::stringstream hash;
+    hash << std::hex << std::setw(16) << std::setfill('0') << checksum(scores);
+    std::cout << "                Scores checksum: " << hash.str()
+              << std::endl;
+
+    if (!scores_file.empty()) {
+      std::fstream output;
+      output.open(scores_file, std::ofstream::out);
+      output << std::setprecision(std::numeric_limits<double>::max_digits10);
+      for (size_t i = 0; i < num_documents; i++)
+        output << scores[i] << std::endl;
+      output.close();
+    }
+  }
+  return EXIT_SUCCESS;
+}
 
+int main(int argc, char *argv[]) {
   ParamsMap pmap;
 
   // Declare the supported options.
@@ -72,59 +340,412 @@ int main(int argc, char *argv[]) {
   pmap.addOptionWithArg<std::string>("dataset", "d",
                                      {"Input dataset in SVML format"});
   pmap.addOptionWithArg<int>("rounds", "r", {"Number of test repetitions"}, 10);
+  pmap.addOptionWithArg<int>("warmup", "w",
+                             {"Number of untimed warm-up repetitions"}, 1);
+  pmap.addOptionWithArg<int>("threads", "t",
+                             {"Maximum number of threads of the throughput",
+                              "test, doubled from 1 (0 means all cores)."},
+                             1);
   pmap.addOptionWithArg<std::string>("scores", "s",
                                      {"File where scores are saved (Optional)."});
+  pmap.addOptionWithArg<std::string>("json", "j",
+                                     {"File where results are saved in JSON",
+                                      "format (Optional)."});
+  pmap.addOptionWithArg<std::string>("model", "m",
+                                     {"XML model scored in-process (Optional).",
+                                      "If not set, the compiled ranker is used."});
+  std::string scoring_engines = "";
+  for (auto i: quickrank::scoring::scoringEngineNames)
+    scoring_engines += i + "|";
+  scoring_engines = scoring_engines.substr(0, scoring_engines.size() - 1);
+  pmap.addOptionWithArg<std::string>("engine", "e",
+                                     {"Scoring engine of the XML model:",
+                                      "[" + scoring_engines + "]."},
+                                     quickrank::scoring::QuickScorer::NAME_);
+  pmap.addOptionWithArg<size_t>("trees-block-size",
+                                {"Trees in each block of block-wise engines",
+                                 "(0 means sized according to caches)."},
+                                0);
+  pmap.addOptionWithArg<size_t>("docs-block-size",
+                                {"Documents in each batch of block-wise engines",
+                                 "(0 means sized according to caches)."},
+                                0);
+  pmap.addOptionWithArg<std::string>("serve",
+                                     {"Serve the scoring requests sent to the",
+                                      "given Unix domain socket, or to the",
+                                      "standard input if \"-\", with a pool of",
+                                      "--threads threads. The --model is",
+                                      "reloaded on SIGHUP."});
+  pmap.addOptionWithArg<size_t>("num-features",
+                                {"Number of features of the documents of",
+                                 "the model served by --serve (default:",
+                                 "the ones used by the model)."},
+                                0);
+  pmap.addOptionWithArg<std::string>("client",
+                                     {"Send the queries of the dataset to the",
+                                      "server listening on the given socket,",
+                                      "from --threads connections at once."});
+  pmap.addOptionWithArg<size_t>("top-k",
+                                {"Number of top ranked documents returned",
+                                 "to --client (0 means all the scores)."},
+                                0);
+  pmap.addOptionWithArg<std::string>("cascade-validation",
+                                     {"Validation dataset where the early-exit",
+                                      "cascade of the --model is learnt",
+                                      "(Optional)."});
+  pmap.addOptionWithArg<size_t>("cascade-k",
+                                {"Number of top documents of each query",
+                                 "kept by the cascade."},
+                                10);
+  pmap.addOptionWithArg<size_t>("cascade-segments",
+                                {"Number of segments of trees of the",
+                                 "cascade."},
+                                10);
+  pmap.addOptionWithArg<double>("cascade-max-loss",
+                                {"Maximum loss of NDCG@k of the cascade on",
+                                 "the validation dataset."},
+                                0.01);
+  pmap.addOptionWithArg<std::string>("anytime-order",
+                                     {"Order of the trees of the --model for",
+                                      "anytime scoring:",
+                                      "[none|weight|variance]."},
+                                     "none");
+  pmap.addOptionWithArg<std::string>("anytime-validation",
+                                     {"Validation dataset where the variance",
+                                      "of the trees is measured."});
+  pmap.addOptionWithArg<size_t>("anytime-trees",
+                                {"Budget of trees of each query of anytime",
+                                 "scoring (0 means no limit)."},
+                                0);
+  pmap.addOptionWithArg<double>("anytime-time",
+                                {"Budget of time of each query of anytime",
+                                 "scoring, in us (0 means no limit)."},
+                                0.0);
 
   bool parse_status = pmap.parse(argc, argv);
-  if (!parse_status || pmap.isSet("help") || !pmap.isSet("dataset")) {
+  if (!parse_status || pmap.isSet("help")
+      || (!pmap.isSet("dataset") && !pmap.isSet("serve"))) {
     std::cout << pmap.help();
     return EXIT_FAILURE;
   }
 
+  // the standard output is kept for the responses when serving on it
+  std::string socket;
+  if (pmap.isSet("serve")) socket = pmap.get<std::string>("serve");
+  if (socket == "-")
+    std::cout.rdbuf(std::cerr.rdbuf());
+
+  print_logo();
+
   // parameters
   std::string dataset_file = pmap.get<std::string>("dataset");
-  size_t rounds = pmap.get<int>("rounds");
+  size_t rounds = std::max(pmap.get<int>("rounds"), 1);
+  size_t warmup = std::max(pmap.get<int>("warmup"), 0);
+  size_t max_threads = pmap.get<int>("threads") > 0 ?
+                       pmap.get<int>("threads") : omp_get_num_procs();
   std::string scores_file;
   if (pmap.isSet("scores")) scores_file = pmap.get<std::string>("scores");
+  std::string json_file;
+  if (pmap.isSet("json")) json_file = pmap.get<std::string>("json");
+
+  if (pmap.isSet("client"))
+    return generate_load(pmap.get<std::string>("client"), dataset_file,
+                         rounds, warmup, max_threads,
+                         pmap.get<size_t>("top-k"), scores_file);
+
+  // load model and build the scoring engine
+  std::shared_ptr<quickrank::scoring::ScoringEngine> engine;
+  std::shared_ptr<quickrank::learning::forests::Mart> forest;
+  std::string model_file;
+  size_t model_features = 0;
+  const bool anytime_scoring = pmap.isSet("anytime-order")
+      || pmap.isSet("anytime-trees") || pmap.isSet("anytime-time");
+  if (pmap.isSet("model")) {
+    model_file = pmap.get<std::string>("model");
+    auto model = quickrank::learning::LTR_Algorithm::load_model_from_file(
+        model_file);
+    engine = quickrank::scoring::scoring_engine_factory(
+        pmap.get<std::string>("engine"), model,
+        pmap.get<size_t>("trees-block-size"),
+        pmap.get<size_t>("docs-block-size"));
+    if (!engine) {
+      std::cerr << " !! Scoring Engine was not set properly" << std::endl;
+      return EXIT_FAILURE;
+    }
+    model_features = model->num_features();
+    forest = std::dynamic_pointer_cast<quickrank::learning::forests::Mart>(
+        model);
+
+    // the cascade replaces the engine of tree ensembles
+    if (pmap.isSet("cascade-validation")) {
+      if (!forest || pmap.get<size_t>("cascade-k") == 0
+          || !quickrank::scoring::QuickScorer::supports(forest->ensemble())) {
+        std::cerr << " !! Cascade was not set properly" << std::endl;
+        return EXIT_FAILURE;
+      }
+      quickrank::io::Svml reader;
+      std::shared_ptr<quickrank::data::Dataset> validation =
+          reader.read_horizontal(pmap.get<std::string>("cascade-validation"));
+      const Ensemble &ensemble = forest->ensemble();
+      auto sentinels = quickrank::scoring::CascadeEngine::even_sentinels(
+          ensemble.get_size(), pmap.get<size_t>("cascade-segments"));
+      auto margins = quickrank::scoring::CascadeEngine::learn_margins(
+          ensemble, sentinels, pmap.get<size_t>("cascade-k"), validation,
+          pmap.get<double>("cascade-max-loss"));
+      engine = std::make_shared<quickrank::scoring::CascadeEngine>(
+          ensemble, sentinels, pmap.get<size_t>("cascade-k"), margins);
+      std::cout << "# cascade sentinels (trees:margin):";
+      for (size_t s = 0; s < sentinels.size(); ++s)
+        std::cout << " " << sentinels[s] << ":" << margins[s];
+      std::cout << std::endl;
+    }
 
+    // so does anytime scoring, after the trees are reordered by importance
+    if (anytime_scoring) {
+      std::string order = pmap.get<std::string>("anytime-order");
+      std::transform(order.begin(), order.end(), order.begin(), ::tolower);
+      if (!forest || pmap.isSet("cascade-validation")
+          || !quickrank::scoring::QuickScorer::supports(forest->ensemble())
+          || (order != "none" && order != "weight" && order != "variance")
+          || (order == "variance" && !pmap.isSet("anytime-validation"))) {
+        std::cerr << " !! Anytime scoring was not set properly" << std::endl;
+        return EXIT_FAILURE;
+      }
+      if (order == "weight") {
+        forest->reorder_trees(
+            quickrank::scoring::AnytimeEngine::order_by_weight(
+                forest->ensemble()));
+      } else if (order == "variance") {
+        quickrank::io::Svml reader;
+        std::shared_ptr<quickrank::data::Dataset> validation =
+            reader.read_horizontal(pmap.get<std::string>("anytime-validation"));
+        forest->reorder_trees(
+            quickrank::scoring::AnytimeEngine::order_by_variance(
+                forest->ensemble(), validation));
+      }
+      const size_t max_trees = pmap.get<size_t>("anytime-trees");
+      engine = std::make_shared<quickrank::scoring::AnytimeEngine>(
+          forest->ensemble(), max_trees ? max_trees : SIZE_MAX,
+          pmap.get<double>("anytime-time") / 1e6);
+    }
+  } else {
+    engine = std::make_shared<CompiledRanker>();
+  }
+  std::cout << "# scoring engine: " << *engine << std::endl;
+
+  if (!socket.empty()) {
+    // documents cannot be narrower than the features used by the model
+    size_t num_features = pmap.get<size_t>("num-features");
+    if (num_features == 0)
+      num_features = model_features;
+    if (num_features == 0 || num_features < model_features) {
+      std::cerr << " !! Number of features was not set properly" << std::endl;
+      return EXIT_FAILURE;
+    }
+    return serve(std::move(engine), socket, num_features, max_threads,
+                 model_file, pmap.get<std::string>("engine"),
+                 pmap.get<size_t>("trees-block-size"),
+                 pmap.get<size_t>("docs-block-size"));
+  }
 
   // read dataset
   quickrank::io::Svml reader;
-  auto dataset = reader.read_horizontal(dataset_file);
+  std::shared_ptr<quickrank::data::Dataset> dataset =
+      reader.read_horizontal(dataset_file);
   std::cout << *dataset;
 
-  // score dataset
-  std::vector<double> scores(dataset->num_instances());
-  auto start_scoring = std::chrono::high_resolution_clock::now();
+  const size_t num_documents = dataset->num_instances();
+  const size_t num_features = dataset->num_features();
+  const size_t num_queries = dataset->num_queries();
+  const float *documents = dataset->at(0, 0);
+  std::vector<double> scores(num_documents);
 
-  for (size_t r = 0; r < rounds; r++) {
-    float *document = dataset->at(0, 0);
-    for (size_t i = 0; i < dataset->num_instances(); i++) {
-      scores[i] = ranker(document);
-      document += dataset->num_features();
+  // engines may score several documents at once, the cascade and anytime
+  // scoring the documents of one query at a time
+  auto cascade = std::dynamic_pointer_cast<quickrank::scoring::CascadeEngine>(
+      engine);
+  auto anytime = std::dynamic_pointer_cast<quickrank::scoring::AnytimeEngine>(
+      engine);
+  auto score_all = [&]() {
+    if (!cascade && !anytime) {
+      engine->score_documents(documents, num_documents, num_features,
+                              &scores[0]);
+      return;
     }
-  }
+    for (size_t q = 0; q < num_queries; q++) {
+      const size_t offset = dataset->offset(q);
+      engine->score_documents(documents + offset * num_features,
+                              dataset->offset(q + 1) - offset, num_features,
+                              &scores[offset]);
+    }
+  };
 
-  auto end_scoring = std::chrono::high_resolution_clock::now();
+  // warm up caches, branch predictors and lazily built structures
+  for (size_t r = 0; r < warmup; r++)
+    score_all();
 
-  double scoring_time =
-      std::chrono::duration_cast<std::chrono::duration<double>>(
-          end_scoring - start_scoring).count();
+  // score dataset
+  auto start_scoring = std::chrono::steady_clock::now();
+  for (size_t r = 0; r < rounds; r++) {
+    QUICKRANK_PERF_PHASE("scoring");
+    score_all();
+  }
+  double scoring_time = elapsed(start_scoring);
 
   std::cout << "       Total scoring time: " << scoring_time << " s."
             << std::endl;
   std::cout << "Avg. Dataset scoring time: " << scoring_time / rounds << " s."
             << std::endl;
   std::cout << "Avg.    Doc. scoring time: "
-            << scoring_time / dataset->num_instances() / rounds << " s."
+            << scoring_time / num_documents / rounds << " s."
+            << std::endl;
+
+  // latency of single documents
+  std::vector<double> latencies(num_documents);
+  for (size_t i = 0; i < num_documents; i++) {
+    auto start = std::chrono::steady_clock::now();
+    scores[i] = engine->score_document(documents + i * num_features);
+    latencies[i] = elapsed(start);
+  }
+  Percentiles document_latency = percentiles(latencies);
+
+  // latency of whole queries, over all the rounds
+  if (cascade)
+    cascade->reset_statistics();
+  if (anytime)
+    anytime->reset_statistics();
+  latencies.resize(num_queries * rounds);
+  for (size_t r = 0; r < rounds; r++) {
+    for (size_t q = 0; q < num_queries; q++) {
+      const size_t offset = dataset->offset(q);
+      auto start = std::chrono::steady_clock::now();
+      engine->score_documents(documents + offset * num_features,
+                              dataset->offset(q + 1) - offset, num_features,
+                              &scores[offset]);
+      latencies[r * num_queries + q] = elapsed(start);
+    }
+  }
+  Percentiles query_latency = percentiles(latencies);
+  double trees_per_document = 0.0;
+  if (cascade)
+    trees_per_document =
+        (double) cascade->trees_evaluated() / cascade->documents_scored();
+  if (anytime)
+    trees_per_document =
+        (double) anytime->trees_evaluated() / anytime->documents_scored();
+
+  std::cout << std::setprecision(3);
+  std::cout << " Doc. latency p50/p99/p999: " << document_latency.p50 << " / "
+            << document_latency.p99 << " / " << document_latency.p999
+            << " us." << std::endl;
+  std::cout << "Query latency p50/p99/p999: " << query_latency.p50 << " / "
+            << query_latency.p99 << " / " << query_latency.p999 << " us."
             << std::endl;
+  if (cascade)
+    std::cout << "  Avg. trees per document: " << trees_per_document
+              << " of " << cascade->num_trees() << std::endl;
+  if (anytime) {
+    std::cout << "  Avg. trees per document: " << trees_per_document
+              << " of " << anytime->num_trees() << std::endl;
+    std::cout << "       Interrupted queries: "
+              << anytime->queries_interrupted() << " of "
+              << num_queries * rounds << std::endl;
+  }
+
+  // throughput with queries scored in parallel
+  std::vector<std::pair<size_t, double>> throughput;
+  for (size_t threads = 1; ; threads = std::min(2 * threads, max_threads)) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < rounds; r++) {
+#pragma omp parallel for schedule(dynamic) num_threads(threads)
+      for (size_t q = 0; q < num_queries; q++) {
+        const size_t offset = dataset->offset(q);
+        engine->score_documents(documents + offset * num_features,
+                                dataset->offset(q + 1) - offset, num_features,
+                                &scores[offset]);
+      }
+    }
+    throughput.push_back(std::make_pair(
+        threads, num_documents * rounds / elapsed(start)));
+    std::cout << "Throughput with " << std::setw(3) << threads
+              << " threads: " << throughput.back().second << " docs/s."
+              << std::endl;
+    if (threads == max_threads)
+      break;
+  }
+
+  // all the scores above are the same, their checksum allows to compare
+  // engines and releases
+  std::stringstream hash;
+  hash << std::hex << std::setw(16) << std::setfill('0') << checksum(scores);
+  std::cout << "          Scores checksum: " << hash.str() << std::endl;
+
+  // quality of anytime scoring with budgets of 10%, 20%, ... of the trees
+  std::vector<size_t> budgets;
+  std::vector<quickrank::MetricScore> quality;
+  if (anytime) {
+    const size_t num_trees = forest->ensemble().get_size();
+    for (size_t i = 1; i <= 10; i++)
+      budgets.push_back((num_trees * i + 9) / 10);
+    quality = quickrank::scoring::AnytimeEngine::quality_curve(
+        forest->ensemble(), budgets, dataset, ANYTIME_CURVE_CUTOFF);
+    for (size_t i = 0; i < budgets.size(); i++)
+      std::cout << "NDCG@" << ANYTIME_CURVE_CUTOFF << " with " << std::setw(6)
+                << budgets[i] << " trees: " << quality[i] << std::endl;
+  }
+
+#ifdef QUICKRANK_PERF_COUNTERS
+  PerfPhase::report(std::cout);
+#endif
+
+  // potentially save results
+  if (!json_file.empty()) {
+    std::ofstream output(json_file);
+    output << std::setprecision(std::numeric_limits<double>::max_digits10);
+    output << "{" << std::endl
+           << "  \"engine\": " << json_string(engine->name()) << ","
+           << std::endl
+           << "  \"model\": " << json_string(model_file) << "," << std::endl
+           << "  \"dataset\": " << json_string(dataset_file) << ","
+           << std::endl
+           << "  \"num_documents\": " << num_documents << "," << std::endl
+           << "  \"num_queries\": " << num_queries << "," << std::endl
+           << "  \"num_features\": " << num_features << "," << std::endl
+           << "  \"rounds\": " << rounds << "," << std::endl
+           << "  \"warmup_rounds\": " << warmup << "," << std::endl
+           << "  \"total_scoring_time\": " << scoring_time << "," << std::endl
+           << "  \"avg_document_scoring_time\": "
+           << scoring_time / num_documents / rounds << "," << std::endl
+           << "  \"document_latency_us\": " << document_latency << ","
+           << std::endl
+           << "  \"query_latency_us\": " << query_latency << "," << std::endl;
+    if (cascade || anytime)
+      output << "  \"avg_trees_per_document\": " << trees_per_document << ","
+             << std::endl;
+    output << "  \"throughput\": [";
+    for (size_t i = 0; i < throughput.size(); i++)
+      output << (i ? ", " : "") << "{\"threads\": " << throughput[i].first
+             << ", \"documents_per_second\": " << throughput[i].second << "}";
+    output << "]," << std::endl;
+    if (anytime) {
+      output << "  \"quality_curve\": [";
+      for (size_t i = 0; i < budgets.size(); i++)
+        output << (i ? ", " : "") << "{\"trees\": " << budgets[i]
+               << ", \"ndcg@" << ANYTIME_CURVE_CUTOFF << "\": " << quality[i]
+               << "}";
+      output << "]," << std::endl;
+    }
+    output << "  \"checksum\": " << json_string(hash.str()) << std::endl
+           << "}" << std::endl;
+    output.close();
+    std::cout << "# Results written to file: " << json_file << std::endl;
+  }
 
-  // potentially save scores
   if (!scores_file.empty()) {
     std::fstream output;
     output.open(scores_file, std::ofstream::out);
     output << std::setprecision(std::numeric_limits<double>::max_digits10);
-    for (size_t i = 0; i < dataset->num_instances(); i++) {
+    for (size_t i = 0; i < num_documents; i++) {
       output << scores[i] << std::endl;
     }
     output.close();
@@ -132,4 +753,3 @@ int main(int argc, char *argv[]) {
 
   return EXIT_SUCCESS;
 }
-
@@ -0,0 +1,217 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "scoring/anytime_engine.h"
+#include "metric/ir/ndcg.h"
+#include "utils/perf_counters.h"
+
+namespace quickrank {
+namespace scoring {
+
+const std::string AnytimeEngine::NAME_ = "ANYTIME";
+
+const size_t AnytimeEngine::DEFAULT_TREES_BLOCK_SIZE;
+
+namespace {
+
+void leaves_range(const RTNode *node, double &min, double &max) {
+  if (node->is_leaf()) {
+    min = std::min(min, node->avglabel);
+    max = std::max(max, node->avglabel);
+    return;
+  }
+  leaves_range(node->left, min, max);
+  leaves_range(node->right, min, max);
+}
+
+/// Returns the trees by decreasing importance, ties in ensemble order.
+std::vector<size_t> by_importance(const std::vector<double> &importance) {
+  std::vector<size_t> order(importance.size());
+  for (size_t i = 0; i < order.size(); ++i)
+    order[i] = i;
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return importance[a] > importance[b];
+  });
+  return order;
+}
+
+}  // namespace
+
+AnytimeEngine::AnytimeEngine(const Ensemble &ensemble, size_t max_trees,
+                             double max_time, size_t trees_block_size)
+    : num_trees_(std::min(max_trees, ensemble.get_size())),
+      max_time_(max_time), trees_evaluated_(0), documents_scored_(0),
+      queries_interrupted_(0) {
+  trees_block_size = std::max(trees_block_size, (size_t) 1);
+  for (size_t first_tree = 0; first_tree < num_trees_;
+       first_tree += trees_block_size) {
+    const size_t last_tree = std::min(first_tree + trees_block_size,
+                                      num_trees_);
+    blocks_.push_back(std::unique_ptr<VQuickScorer>(new VQuickScorer(
+        ensemble, VQuickScorer::InstructionSet::AVX512, first_tree,
+        last_tree)));
+    block_sizes_.push_back(last_tree - first_tree);
+  }
+}
+
+Score AnytimeEngine::score_document(const Feature *d) const {
+  Score score;
+  score_documents(d, 1, 0, &score);
+  return score;
+}
+
+void AnytimeEngine::score_documents(const Feature *d, size_t num_documents,
+                                    size_t stride, Score *scores) const {
+  auto start = std::chrono::steady_clock::now();
+  std::fill(scores, scores + num_documents, 0.0);
+  uint64_t trees = 0;
+  for (size_t b = 0; b < blocks_.size(); ++b) {
+    if (b > 0 && max_time_ > 0.0
+        && std::chrono::duration_cast<std::chrono::duration<double>>(
+            std::chrono::steady_clock::now() - start).count() >= max_time_) {
+      ++queries_interrupted_;
+      break;
+    }
+    blocks_[b]->accumulate_documents(d, num_documents, stride, scores);
+    trees += block_sizes_[b];
+  }
+  trees_evaluated_ += trees * num_documents;
+  documents_scored_ += num_documents;
+}
+
+void AnytimeEngine::score_dataset(std::shared_ptr<data::Dataset> dataset,
+                                  Score *scores) const {
+  QUICKRANK_PERF_PHASE("scoring");
+  const size_t stride = dataset->num_features();
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t q = 0; q < dataset->num_queries(); ++q) {
+    const size_t offset = dataset->offset(q);
+    score_documents(dataset->at(offset, 0), dataset->offset(q + 1) - offset,
+                    stride, scores + offset);
+  }
+}
+
+std::vector<size_t> AnytimeEngine::order_by_weight(const Ensemble &ensemble) {
+  std::vector<double> importance(ensemble.get_size());
+  for (size_t t = 0; t < importance.size(); ++t) {
+    double min = ensemble.getTree(t)->avglabel;
+    double max = min;
+    leaves_range(ensemble.getTree(t), min, max);
+    importance[t] = std::abs(ensemble.getWeight(t)) * (max - min);
+  }
+  return by_importance(importance);
+}
+
+std::vector<size_t> AnytimeEngine::order_by_variance(
+    const Ensemble &ensemble, std::shared_ptr<data::Dataset> validation) {
+  const size_t num_trees = ensemble.get_size();
+  const size_t num_queries = validation->num_queries();
+  std::vector<double> importance(num_trees, 0.0);
+
+  // the variances of a block of queries are computed in parallel, and they
+  // are summed in query order, so that the order of the trees does not
+  // depend on the number of threads
+  const size_t block_size = 256;
+  std::vector<double> variances(std::min(block_size, num_queries) * num_trees);
+  for (size_t first = 0; first < num_queries; first += block_size) {
+    const size_t last = std::min(first + block_size, num_queries);
+    #pragma omp parallel
+    {
+      std::vector<double> sum(num_trees);
+      std::vector<double> sum_squares(num_trees);
+      #pragma omp for schedule(dynamic)
+      for (size_t q = first; q < last; ++q) {
+        const size_t offset = validation->offset(q);
+        const size_t num_documents = validation->offset(q + 1) - offset;
+        double *variance = &variances[(q - first) * num_trees];
+        std::fill(sum.begin(), sum.end(), 0.0);
+        std::fill(sum_squares.begin(), sum_squares.end(), 0.0);
+        for (size_t i = offset; i < offset + num_documents; ++i) {
+          auto partial = ensemble.partial_scores_instance(
+              validation->at(i, 0));
+          for (size_t t = 0; t < num_trees; ++t) {
+            sum[t] += (*partial)[t];
+            sum_squares[t] += (*partial)[t] * (*partial)[t];
+          }
+        }
+        std::fill(variance, variance + num_trees, 0.0);
+        for (size_t t = 0; t < num_trees && num_documents > 0; ++t) {
+          const double mean = sum[t] / num_documents;
+          variance[t] = std::max(sum_squares[t] / num_documents - mean * mean,
+                                 0.0);
+        }
+      }
+    }
+    for (size_t q = first; q < last; ++q)
+      for (size_t t = 0; t < num_trees; ++t)
+        importance[t] += variances[(q - first) * num_trees + t];
+  }
+  return by_importance(importance);
+}
+
+std::vector<MetricScore> AnytimeEngine::quality_curve(
+    const Ensemble &ensemble, const std::vector<size_t> &budgets,
+    std::shared_ptr<data::Dataset> dataset, size_t k) {
+  const size_t num_queries = dataset->num_queries();
+  const size_t num_features = dataset->num_features();
+  metric::ir::Ndcg ndcg(k);
+  std::vector<MetricScore> quality(budgets.size(), 0.0);
+
+  // the quality of each query is summed in query order, as in
+  // Metric::evaluate_dataset
+  std::vector<MetricScore> query_quality(num_queries * budgets.size());
+  #pragma omp parallel
+  {
+    std::vector<Score> scores;
+    #pragma omp for schedule(dynamic)
+    for (size_t q = 0; q < num_queries; ++q) {
+      const size_t offset = dataset->offset(q);
+      const size_t num_documents = dataset->offset(q + 1) - offset;
+      data::QueryResults results = dataset->getQueryResultsView(q);
+      scores.assign(num_documents, 0.0);
+      size_t first_tree = 0;
+      for (size_t b = 0; b < budgets.size(); ++b) {
+        const size_t last_tree = std::min(budgets[b], ensemble.get_size());
+        if (last_tree > first_tree)
+          ensemble.add_scores(dataset->at(offset, 0), num_documents,
+                              num_features, 1, scores.data(), first_tree,
+                              last_tree);
+        first_tree = std::max(first_tree, last_tree);
+        query_quality[q * budgets.size() + b] =
+            ndcg.evaluate_result_list(&results, scores.data());
+      }
+    }
+  }
+  for (size_t q = 0; q < num_queries; ++q)
+    for (size_t b = 0; b < budgets.size(); ++b)
+      quality[b] += query_quality[q * budgets.size() + b];
+
+  for (auto &q: quality)
+    q = num_queries ? q / num_queries : 0.0;
+  return quality;
+}
+
+}  // namespace scoring
+}  // namespace quickrank
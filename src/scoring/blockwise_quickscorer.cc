@@ -0,0 +1,144 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include <algorithm>
+
+#include "scoring/blockwise_quickscorer.h"
+#include "utils/cacheinfo.h"
+#include "utils/perf_counters.h"
+
+namespace quickrank {
+namespace scoring {
+
+const std::string BlockWiseQuickScorer::NAME_ = "BWQUICKSCORER";
+
+namespace {
+
+/// Used when the size of a cache cannot be detected.
+const size_t DEFAULT_L2_CACHE_SIZE = 256 << 10;
+
+/// Documents scored at once by the widest VQuickScorer kernel.
+const size_t DOCUMENTS_WIDTH = 16;
+
+/// Maximum number of groups of DOCUMENTS_WIDTH documents in a batch.
+const size_t MAX_DOCUMENTS_BLOCKS = 64;
+
+size_t num_leaves(const RTNode *node) {
+  if (node->is_leaf())
+    return 1;
+  return num_leaves(node->left) + num_leaves(node->right);
+}
+
+/// Returns the bytes needed by VQuickScorer to score a tree: nodes
+/// (threshold, tree id and bitvector), leaves, and the bitvectors of the
+/// documents scored at once.
+size_t tree_footprint(const RTNode *root) {
+  const size_t leaves = num_leaves(root);
+  return (leaves - 1) * (sizeof(Feature) + sizeof(uint32_t) + sizeof(uint64_t))
+      + leaves * sizeof(double)
+      + DOCUMENTS_WIDTH * sizeof(uint64_t);
+}
+
+}  // namespace
+
+BlockWiseQuickScorer::BlockWiseQuickScorer(const Ensemble &ensemble,
+                                           size_t trees_block_size,
+                                           size_t documents_block_size)
+    : documents_block_size_(documents_block_size) {
+  size_t cache_budget = data_cache_size(2);
+  if (cache_budget == 0)
+    cache_budget = DEFAULT_L2_CACHE_SIZE;
+  cache_budget /= 2;
+
+  size_t first_tree = 0;
+  while (first_tree < ensemble.get_size()) {
+    size_t last_tree = first_tree;
+    if (trees_block_size) {
+      last_tree = std::min(first_tree + trees_block_size, ensemble.get_size());
+    } else {
+      // add trees until the block fills its share of the cache
+      size_t footprint = 0;
+      while (last_tree < ensemble.get_size()
+          && (last_tree == first_tree || footprint
+              + tree_footprint(ensemble.getTree(last_tree)) <= cache_budget))
+        footprint += tree_footprint(ensemble.getTree(last_tree++));
+    }
+    blocks_.push_back(std::unique_ptr<VQuickScorer>(new VQuickScorer(
+        ensemble, VQuickScorer::InstructionSet::AVX512, first_tree,
+        last_tree)));
+    first_tree = last_tree;
+  }
+}
+
+size_t BlockWiseQuickScorer::documents_block_size(size_t stride) const {
+  if (documents_block_size_)
+    return documents_block_size_;
+
+  size_t cache_budget = data_cache_size(3);
+  if (cache_budget == 0)
+    cache_budget = data_cache_size(2);
+  if (cache_budget == 0)
+    cache_budget = DEFAULT_L2_CACHE_SIZE;
+  cache_budget /= 4;
+
+  // a multiple of the documents scored at once, and small enough to leave
+  // several batches to the threads scoring a dataset
+  size_t num_blocks = cache_budget
+      / (std::max(stride, (size_t) 1) * sizeof(Feature) * DOCUMENTS_WIDTH);
+  num_blocks = std::min(std::max(num_blocks, (size_t) 1), MAX_DOCUMENTS_BLOCKS);
+  return num_blocks * DOCUMENTS_WIDTH;
+}
+
+Score BlockWiseQuickScorer::score_document(const Feature *d) const {
+  Score score = 0.0;
+  for (auto &block: blocks_)
+    block->accumulate_documents(d, 1, 0, &score);
+  return score;
+}
+
+void BlockWiseQuickScorer::score_documents(const Feature *d,
+                                           size_t num_documents,
+                                           size_t stride,
+                                           Score *scores) const {
+  const size_t batch_size = documents_block_size(stride);
+  for (size_t i = 0; i < num_documents; i += batch_size) {
+    const size_t batch = std::min(batch_size, num_documents - i);
+    std::fill(scores + i, scores + i + batch, 0.0);
+    for (auto &block: blocks_)
+      block->accumulate_documents(d + i * stride, batch, stride, scores + i);
+  }
+}
+
+void BlockWiseQuickScorer::score_dataset(
+    std::shared_ptr<data::Dataset> dataset, Score *scores) const {
+  QUICKRANK_PERF_PHASE("scoring");
+  const Feature *d = dataset->at(0, 0);
+  const size_t num_documents = dataset->num_instances();
+  const size_t stride = dataset->num_features();
+  const size_t batch_size = documents_block_size(stride);
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t i = 0; i < num_documents; i += batch_size)
+    score_documents(d + i * stride, std::min(batch_size, num_documents - i),
+                    stride, scores + i);
+}
+
+}  // namespace scoring
+}  // namespace quickrank
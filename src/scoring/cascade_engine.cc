@@ -0,0 +1,273 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <limits>
+
+#include "scoring/cascade_engine.h"
+#include "metric/ir/ndcg.h"
+#include "utils/perf_counters.h"
+
+namespace quickrank {
+namespace scoring {
+
+const std::string CascadeEngine::NAME_ = "CASCADE";
+
+const size_t CascadeEngine::NUM_CANDIDATE_MARGINS;
+
+namespace {
+
+/// Returns the k-th highest of the given scores, which are reordered.
+Score kth_highest(std::vector<Score> &scores, size_t k) {
+  std::nth_element(scores.begin(), scores.begin() + k - 1, scores.end(),
+                   std::greater<Score>());
+  return scores[k - 1];
+}
+
+/// Leaves in \a ids the documents of a query reaching the sentinel \a last,
+/// given the partial scores at each sentinel of the documents starting at
+/// \a offset.
+void survivors(const std::vector<std::vector<Score>> &partials, size_t offset,
+               size_t num_documents, const std::vector<double> &margins,
+               size_t k, size_t last, std::vector<size_t> &ids,
+               std::vector<Score> &buffer) {
+  ids.resize(num_documents);
+  for (size_t i = 0; i < num_documents; ++i)
+    ids[i] = i;
+  for (size_t s = 0; s < last; ++s) {
+    if (ids.size() <= k || std::isinf(margins[s]))
+      continue;
+    const Score *partial = partials[s].data() + offset;
+    buffer.clear();
+    for (size_t i: ids)
+      buffer.push_back(partial[i]);
+    const Score threshold = kth_highest(buffer, k) - margins[s];
+    ids.erase(std::remove_if(ids.begin(), ids.end(), [&](size_t i) {
+      return !(partial[i] >= threshold);
+    }), ids.end());
+  }
+}
+
+}  // namespace
+
+CascadeEngine::CascadeEngine(const Ensemble &ensemble,
+                             const std::vector<size_t> &sentinels, size_t k,
+                             const std::vector<double> &margins)
+    : sentinels_(sentinels), margins_(margins), k_(k),
+      num_trees_(ensemble.get_size()), trees_evaluated_(0),
+      documents_scored_(0) {
+  if (k_ == 0 || sentinels_.size() != margins_.size()) {
+    std::cerr << "!!! " << NAME_ << " needs k > 0 and a margin per sentinel"
+              << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  size_t first_tree = 0;
+  for (size_t s = 0; s <= sentinels_.size(); ++s) {
+    size_t last_tree = s < sentinels_.size() ? sentinels_[s] : num_trees_;
+    if (last_tree <= first_tree || last_tree > num_trees_) {
+      std::cerr << "!!! " << NAME_ << " sentinels must be increasing and "
+                << "within the " << num_trees_ << " trees" << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    segments_.push_back(std::unique_ptr<VQuickScorer>(new VQuickScorer(
+        ensemble, VQuickScorer::InstructionSet::AVX512, first_tree,
+        last_tree)));
+    first_tree = last_tree;
+  }
+}
+
+Score CascadeEngine::score_document(const Feature *d) const {
+  Score score = 0.0;
+  for (auto &segment: segments_)
+    segment->accumulate_documents(d, 1, 0, &score);
+  trees_evaluated_ += num_trees_;
+  documents_scored_ += 1;
+  return score;
+}
+
+void CascadeEngine::score_documents(const Feature *d, size_t num_documents,
+                                    size_t stride, Score *scores) const {
+  // the documents still in the cascade, with their partial scores and
+  // features gathered after the first sentinel
+  static thread_local std::vector<size_t> ids;
+  static thread_local std::vector<Score> partial;
+  static thread_local std::vector<Score> buffer;
+  static thread_local std::vector<Feature> rows;
+
+  ids.resize(num_documents);
+  for (size_t i = 0; i < num_documents; ++i)
+    ids[i] = i;
+  partial.assign(num_documents, 0.0);
+  const Feature *documents = d;
+  size_t alive = num_documents;
+  uint64_t trees = 0;
+
+  for (size_t s = 0; s < segments_.size(); ++s) {
+    segments_[s]->accumulate_documents(documents, alive, stride,
+                                       partial.data());
+    trees += alive * ((s < sentinels_.size() ? sentinels_[s] : num_trees_)
+        - (s > 0 ? sentinels_[s - 1] : 0));
+    if (s == sentinels_.size() || alive <= k_ || std::isinf(margins_[s]))
+      continue;
+
+    buffer.assign(partial.begin(), partial.begin() + alive);
+    const Score threshold = kth_highest(buffer, k_) - margins_[s];
+    if (documents != rows.data())
+      rows.resize(alive * stride);
+    size_t kept = 0;
+    for (size_t i = 0; i < alive; ++i) {
+      if (partial[i] >= threshold) {
+        if (kept != i || documents != rows.data())
+          std::copy(documents + i * stride, documents + (i + 1) * stride,
+                    rows.begin() + kept * stride);
+        ids[kept] = ids[i];
+        partial[kept++] = partial[i];
+      } else {
+        scores[ids[i]] = -std::numeric_limits<Score>::infinity();
+      }
+    }
+    alive = kept;
+    documents = rows.data();
+  }
+
+  for (size_t i = 0; i < alive; ++i)
+    scores[ids[i]] = partial[i];
+  trees_evaluated_ += trees;
+  documents_scored_ += num_documents;
+}
+
+void CascadeEngine::score_dataset(std::shared_ptr<data::Dataset> dataset,
+                                  Score *scores) const {
+  QUICKRANK_PERF_PHASE("scoring");
+  const size_t stride = dataset->num_features();
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t q = 0; q < dataset->num_queries(); ++q) {
+    const size_t offset = dataset->offset(q);
+    score_documents(dataset->at(offset, 0), dataset->offset(q + 1) - offset,
+                    stride, scores + offset);
+  }
+}
+
+std::vector<size_t> CascadeEngine::even_sentinels(size_t num_trees,
+                                                  size_t num_segments) {
+  std::vector<size_t> sentinels;
+  for (size_t s = 1; s < num_segments; ++s) {
+    size_t sentinel = s * num_trees / num_segments;
+    if (sentinel > 0 && sentinel < num_trees
+        && (sentinels.empty() || sentinel > sentinels.back()))
+      sentinels.push_back(sentinel);
+  }
+  return sentinels;
+}
+
+std::vector<double> CascadeEngine::learn_margins(
+    const Ensemble &ensemble, const std::vector<size_t> &sentinels, size_t k,
+    std::shared_ptr<data::Dataset> validation, double max_loss) {
+  const size_t num_queries = validation->num_queries();
+  const size_t num_features = validation->num_features();
+  const size_t num_sentinels = sentinels.size();
+
+  // partial scores of the documents at each sentinel, then the final ones
+  std::vector<std::vector<Score>> partials(
+      num_sentinels + 1, std::vector<Score>(validation->num_instances()));
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t q = 0; q < num_queries; ++q) {
+    const size_t offset = validation->offset(q);
+    const size_t num_documents = validation->offset(q + 1) - offset;
+    std::vector<Score> scores(num_documents, 0.0);
+    for (size_t s = 0; s <= num_sentinels; ++s) {
+      ensemble.add_scores(validation->at(offset, 0), num_documents,
+                          num_features, 1, scores.data(),
+                          s > 0 ? sentinels[s - 1] : 0,
+                          s < num_sentinels ? sentinels[s] : SIZE_MAX);
+      std::copy(scores.begin(), scores.end(), partials[s].begin() + offset);
+    }
+  }
+
+  // mean NDCG@k of the cascade, exited documents are ranked last
+  metric::ir::Ndcg ndcg(k);
+  auto mean_ndcg = [&](const std::vector<double> &margins) {
+    MetricScore sum = 0.0;
+    #pragma omp parallel for reduction(+:sum) schedule(dynamic)
+    for (size_t q = 0; q < num_queries; ++q) {
+      static thread_local std::vector<size_t> ids;
+      static thread_local std::vector<Score> buffer;
+      static thread_local std::vector<Score> scores;
+      const size_t offset = validation->offset(q);
+      const size_t num_documents = validation->offset(q + 1) - offset;
+      survivors(partials, offset, num_documents, margins, k, num_sentinels,
+                ids, buffer);
+      scores.assign(num_documents, -std::numeric_limits<Score>::infinity());
+      for (size_t i: ids)
+        scores[i] = partials[num_sentinels][offset + i];
+      data::QueryResults results = validation->getQueryResultsView(q);
+      sum += ndcg.evaluate_result_list(&results, scores.data());
+    }
+    return num_queries ? sum / num_queries : 0.0;
+  };
+
+  std::vector<double> margins(num_sentinels,
+                              std::numeric_limits<double>::infinity());
+  const MetricScore target = mean_ndcg(margins) - max_loss;
+
+  for (size_t s = 0; s < num_sentinels; ++s) {
+    // the gap of each document below the k-th highest partial score
+    std::vector<double> gaps;
+    std::vector<size_t> ids;
+    std::vector<Score> buffer;
+    for (size_t q = 0; q < num_queries; ++q) {
+      const size_t offset = validation->offset(q);
+      survivors(partials, offset, validation->offset(q + 1) - offset, margins,
+                k, s, ids, buffer);
+      if (ids.size() <= k)
+        continue;
+      buffer.clear();
+      for (size_t i: ids)
+        buffer.push_back(partials[s][offset + i]);
+      const Score kth = kth_highest(buffer, k);
+      for (size_t i: ids)
+        gaps.push_back(std::max(kth - partials[s][offset + i], 0.0));
+    }
+    if (gaps.empty())
+      continue;
+
+    // the largest gap keeps all the documents, i.e., it disables the sentinel
+    std::sort(gaps.begin(), gaps.end());
+    bool bounded = false;
+    for (size_t c = 0; c < NUM_CANDIDATE_MARGINS && !bounded; ++c) {
+      const double margin =
+          gaps[c * (gaps.size() - 1) / (NUM_CANDIDATE_MARGINS - 1)];
+      if (c > 0 && margin == margins[s])
+        continue;
+      margins[s] = margin;
+      bounded = mean_ndcg(margins) >= target;
+    }
+    if (!bounded)
+      margins[s] = std::numeric_limits<double>::infinity();
+  }
+  return margins;
+}
+
+}  // namespace scoring
+}  // namespace quickrank
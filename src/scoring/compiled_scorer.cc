@@ -0,0 +1,163 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <dlfcn.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "scoring/compiled_scorer.h"
+#include "io/generate_conditional_operators.h"
+#include "io/generate_oblivious.h"
+
+namespace quickrank {
+namespace scoring {
+
+const std::string CompiledScorer::PREFIX_ = "COMPILED_";
+
+namespace {
+
+/// The C entry point appended to the generated code.
+const char *ENTRY_POINT = "quickrank_ranker";
+
+/// The flags used to compile the generated code. Contractions into fused
+/// multiply-adds are disabled, to keep the scores of the model.
+const char *COMPILER_FLAGS =
+    "-O3 -march=native -ffp-contract=off -shared -fPIC";
+
+std::string plugins_dir() {
+  const char *dir = getenv("QUICKRANK_PLUGINS_DIR");
+  if (dir && *dir)
+    return dir;
+  const char *tmp = getenv("TMPDIR");
+  return std::string(tmp && *tmp ? tmp : "/tmp") + "/quickrank-plugins";
+}
+
+std::string compiler() {
+  const char *cxx = getenv("CXX");
+  return cxx && *cxx ? cxx : "c++";
+}
+
+}  // namespace
+
+CompiledScorer::CompiledScorer(const std::string &generator)
+    : generator_(generator) {
+}
+
+std::shared_ptr<CompiledScorer> CompiledScorer::create(
+    const learning::LTR_Algorithm &ranker, const std::string &generator) {
+  std::shared_ptr<CompiledScorer> scorer(new CompiledScorer(generator));
+  if (!scorer->load(ranker))
+    return nullptr;
+  return scorer;
+}
+
+bool CompiledScorer::load(const learning::LTR_Algorithm &ranker) {
+  // the cache key covers everything the shared object depends on
+  pugi::xml_document *model = ranker.get_xml_model();
+  std::ostringstream xml;
+  model->save(xml, "\t", pugi::format_default | pugi::format_no_declaration);
+  delete model;
+  std::ostringstream key;
+  key << std::hex
+      << std::hash<std::string>()(generator_ + '\n' + compiler() + ' '
+                                      + COMPILER_FLAGS + '\n' + xml.str());
+
+  const std::string dir = plugins_dir();
+  mkdir(dir.c_str(), 0755);
+  const std::string basename = dir + "/" + generator_ + "-" + key.str();
+  plugin_path_ = basename + ".so";
+
+  if (access(plugin_path_.c_str(), R_OK) != 0) {
+    // concurrent runs write and compile their own files, and the shared
+    // object appears in the cache at once
+    const std::string tmp_basename =
+        basename + "." + std::to_string(getpid()) + ".tmp";
+    std::ofstream os(tmp_basename + ".xml");
+    os << xml.str();
+    os.close();
+    bool compiled = false;
+    if (!os)
+      std::cerr << "!!! Model " << tmp_basename << ".xml cannot be written."
+                << std::endl;
+    else
+      compiled = compile(tmp_basename);
+    std::remove((tmp_basename + ".xml").c_str());
+    std::remove((tmp_basename + ".cc").c_str());
+    if (!compiled)
+      return false;
+  }
+
+  handle_ = dlopen(plugin_path_.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (handle_)
+    ranker_ = (double (*)(float *)) dlsym(handle_, ENTRY_POINT);
+  if (!ranker_) {
+    std::cerr << "!!! Scorer " << plugin_path_ << " cannot be loaded: "
+              << dlerror() << std::endl;
+    return false;
+  }
+  return true;
+}
+
+CompiledScorer::~CompiledScorer() {
+  if (handle_)
+    dlclose(handle_);
+}
+
+bool CompiledScorer::compile(const std::string &tmp_basename) {
+  const std::string xml_path = tmp_basename + ".xml";
+  const std::string code_path = tmp_basename + ".cc";
+  const std::string tmp_path = tmp_basename + ".so";
+  if (generator_ == "CONDOP") {
+    io::GenOpCond generator;
+    generator.generate_conditional_operators_code(xml_path, code_path);
+  } else {
+    io::GenOblivious generator;
+    generator.generate_oblivious_code(xml_path, code_path);
+  }
+
+  std::ofstream os(code_path, std::ofstream::app);
+  os << std::endl << "extern \"C\" double " << ENTRY_POINT
+     << "(float *v) {" << std::endl << "  return ranker(v);" << std::endl
+     << "}" << std::endl;
+  os.close();
+
+  const std::string command = compiler() + " " + COMPILER_FLAGS + " -o '"
+      + tmp_path + "' '" + code_path + "'";
+  std::cout << "# compiling scorer: " << command << std::endl;
+  if (!os || std::system(command.c_str()) != 0
+      || std::rename(tmp_path.c_str(), plugin_path_.c_str()) != 0) {
+    std::cerr << "!!! Scorer " << code_path << " cannot be compiled."
+              << std::endl;
+    std::remove(tmp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+}  // namespace scoring
+}  // namespace quickrank
@@ -0,0 +1,95 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "scoring/model_handle.h"
+
+#include <iostream>
+
+#include "learning/ltr_algorithm.h"
+#include "scoring/scoring_engine_factory.h"
+
+namespace quickrank {
+namespace scoring {
+
+ModelHandle::ModelHandle(std::shared_ptr<ScoringEngine> engine)
+    : engine_(std::move(engine)), version_(0) {
+}
+
+ModelHandle::~ModelHandle() {
+  wait();
+}
+
+std::shared_ptr<ScoringEngine> ModelHandle::get() const {
+  return std::atomic_load(&engine_);
+}
+
+size_t ModelHandle::version() const {
+  return version_;
+}
+
+void ModelHandle::publish(std::shared_ptr<ScoringEngine> engine) {
+  // no new snapshot of the old engine can be taken, the current ones free it
+  std::atomic_exchange(&engine_, std::move(engine));
+  ++version_;
+}
+
+void ModelHandle::reload(Loader loader) {
+  std::lock_guard<std::mutex> lock(reload_mutex_);
+  if (loader_.joinable())
+    loader_.join();
+  loader_ = std::thread([this, loader]() {
+    std::shared_ptr<ScoringEngine> engine = loader();
+    failed_ = !engine;
+    if (engine)
+      publish(engine);
+  });
+}
+
+void ModelHandle::reload(const std::string &model_file,
+                         const std::string &engine, size_t num_features,
+                         size_t trees_block_size,
+                         size_t documents_block_size) {
+  reload([model_file, engine, num_features, trees_block_size,
+             documents_block_size]() {
+    // any error keeps the current model, as the server must keep running
+    auto model = learning::LTR_Algorithm::try_load_model_from_file(model_file);
+    if (!model)
+      return std::shared_ptr<ScoringEngine>();
+    if (model->num_features() > num_features) {
+      std::cerr << "!!! Model " + model_file + " uses "
+                << model->num_features() << " features, while documents have "
+                << num_features << "." << std::endl;
+      return std::shared_ptr<ScoringEngine>();
+    }
+    return scoring_engine_factory(engine, model, trees_block_size,
+                                  documents_block_size);
+  });
+}
+
+bool ModelHandle::wait() {
+  std::lock_guard<std::mutex> lock(reload_mutex_);
+  if (loader_.joinable())
+    loader_.join();
+  return !failed_;
+}
+
+}  // namespace scoring
+}  // namespace quickrank
@@ -0,0 +1,144 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include <algorithm>
+
+#include "scoring/oblivious_engine.h"
+
+namespace quickrank {
+namespace scoring {
+
+const std::string ObliviousEngine::NAME_ = "OBLIVIOUS";
+
+ObliviousEngine::ObliviousEngine(const Ensemble &ensemble) {
+  if (!supports(ensemble)) {
+    std::cerr << "!!! " << NAME_ << " supports oblivious trees with depth at "
+              << "most " << MAX_DEPTH << " only." << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  for (size_t t = 0; t < ensemble.get_size(); ++t) {
+    oblivious_tree tree;
+    tree.depth = 0;
+    tree.first_level = features_.size();
+    tree.first_leaf = leaves_.size();
+
+    // visit the tree level by level, from left to right
+    std::vector<const RTNode *> level(1, ensemble.getTree(t));
+    while (!level[0]->is_leaf()) {
+      const RTNode *first = level[0];
+      std::vector<const RTNode *> next;
+      for (const RTNode *node: level) {
+        next.push_back(node->left);
+        next.push_back(node->right);
+      }
+      ++tree.depth;
+      features_.push_back(first->get_feature_idx());
+      thresholds_.push_back(first->threshold);
+      level.swap(next);
+    }
+
+    // the leaves are in the order of their bitmask
+    for (const RTNode *node: level)
+      leaves_.push_back(node->avglabel);
+
+    trees_.push_back(tree);
+    weights_.push_back(ensemble.getWeight(t));
+  }
+}
+
+bool ObliviousEngine::supports(const Ensemble &ensemble) {
+  for (size_t t = 0; t < ensemble.get_size(); ++t) {
+    std::vector<const RTNode *> level(1, ensemble.getTree(t));
+    size_t depth = 0;
+    while (!level[0]->is_leaf()) {
+      const RTNode *first = level[0];
+      std::vector<const RTNode *> next;
+      for (const RTNode *node: level) {
+        if (node->is_leaf()
+            || node->get_feature_idx() != first->get_feature_idx()
+            || node->threshold != first->threshold)
+          return false;
+        next.push_back(node->left);
+        next.push_back(node->right);
+      }
+      if (++depth > MAX_DEPTH)
+        return false;
+      level.swap(next);
+    }
+    for (const RTNode *node: level)
+      if (!node->is_leaf())
+        return false;
+  }
+  return true;
+}
+
+Score ObliviousEngine::score_document(const Feature *d) const {
+  double score = 0.0;
+  for (size_t t = 0; t < trees_.size(); ++t) {
+    const uint32_t *features = features_.data() + trees_[t].first_level;
+    const Feature *thresholds = thresholds_.data() + trees_[t].first_level;
+    size_t leaf = 0;
+    for (size_t level = 0; level < trees_[t].depth; ++level)
+      leaf = (leaf << 1) | !(d[features[level]] <= thresholds[level]);
+    score += leaves_[trees_[t].first_leaf + leaf] * weights_[t];
+  }
+  return score;
+}
+
+void ObliviousEngine::score_documents(const Feature *d, size_t num_documents,
+                                      size_t stride, Score *scores) const {
+  for (size_t i = 0; i < num_documents; i += DOCUMENTS_AT_ONCE)
+    score_block(d + i * stride,
+                std::min(DOCUMENTS_AT_ONCE, num_documents - i), stride,
+                scores + i);
+}
+
+void ObliviousEngine::score_block(const Feature *d, size_t num_documents,
+                                  size_t stride, Score *scores) const {
+  // missing documents are replaced by the first one
+  const Feature *docs[DOCUMENTS_AT_ONCE];
+  for (size_t j = 0; j < DOCUMENTS_AT_ONCE; ++j)
+    docs[j] = d + (j < num_documents ? j : 0) * stride;
+
+  double sums[DOCUMENTS_AT_ONCE] = {0.0};
+  for (size_t t = 0; t < trees_.size(); ++t) {
+    const uint32_t *features = features_.data() + trees_[t].first_level;
+    const Feature *thresholds = thresholds_.data() + trees_[t].first_level;
+
+    // the false test, NaN included, sets the bit of the level
+    uint32_t leaf[DOCUMENTS_AT_ONCE] = {0};
+    for (size_t level = 0; level < trees_[t].depth; ++level) {
+      const uint32_t feature = features[level];
+      const Feature threshold = thresholds[level];
+      for (size_t j = 0; j < DOCUMENTS_AT_ONCE; ++j)
+        leaf[j] = (leaf[j] << 1) | !(docs[j][feature] <= threshold);
+    }
+
+    const double *leaves = leaves_.data() + trees_[t].first_leaf;
+    for (size_t j = 0; j < DOCUMENTS_AT_ONCE; ++j)
+      sums[j] += leaves[leaf[j]] * weights_[t];
+  }
+  std::copy(sums, sums + num_documents, scores);
+}
+
+}  // namespace scoring
+}  // namespace quickrank
@@ -0,0 +1,143 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include <algorithm>
+#include <tuple>
+
+#include "scoring/quickscorer.h"
+
+namespace quickrank {
+namespace scoring {
+
+const std::string QuickScorer::NAME_ = "QUICKSCORER";
+
+namespace {
+
+struct QSNode {
+  size_t feature;
+  Feature threshold;
+  uint32_t tree_id;
+  uint64_t mask;
+
+  bool operator<(const QSNode &other) const {
+    return std::tie(feature, threshold, tree_id)
+        < std::tie(other.feature, other.threshold, other.tree_id);
+  }
+};
+
+/// Numbers the leaves of the subtree rooted in \a node from left to right,
+/// appending their values to \a leaf_values, and appends its internal nodes
+/// to \a nodes.
+void visit(const RTNode *node, uint32_t tree_id, size_t leaf_offset,
+           std::vector<double> &leaf_values, std::vector<QSNode> &nodes) {
+  if (node->is_leaf()) {
+    if (leaf_values.size() - leaf_offset >= QuickScorer::MAX_LEAVES) {
+      std::cerr << "!!! " << QuickScorer::NAME_
+                << " supports trees with at most " << QuickScorer::MAX_LEAVES
+                << " leaves." << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    leaf_values.push_back(node->avglabel);
+    return;
+  }
+
+  // the leaves of the left subtree are not reachable on a false test
+  size_t first_leaf = leaf_values.size() - leaf_offset;
+  visit(node->left, tree_id, leaf_offset, leaf_values, nodes);
+  size_t last_leaf = leaf_values.size() - leaf_offset;
+  // the right subtree has at least one leaf, so the shift is below 64
+  uint64_t left_leaves =
+      (((uint64_t) 1 << (last_leaf - first_leaf)) - 1) << first_leaf;
+  nodes.push_back({node->get_feature_idx(), node->threshold, tree_id,
+                   ~left_leaves});
+
+  visit(node->right, tree_id, leaf_offset, leaf_values, nodes);
+}
+
+size_t num_leaves(const RTNode *node) {
+  if (node->is_leaf())
+    return 1;
+  return num_leaves(node->left) + num_leaves(node->right);
+}
+
+}  // namespace
+
+bool QuickScorer::supports(const Ensemble &ensemble) {
+  for (size_t t = 0; t < ensemble.get_size(); ++t)
+    if (num_leaves(ensemble.getTree(t)) > MAX_LEAVES)
+      return false;
+  return true;
+}
+
+QuickScorer::QuickScorer(const Ensemble &ensemble, size_t first_tree,
+                         size_t last_tree) {
+  last_tree = std::min(last_tree, ensemble.get_size());
+  first_tree = std::min(first_tree, last_tree);
+  num_trees_ = last_tree - first_tree;
+
+  std::vector<QSNode> nodes;
+  for (size_t t = 0; t < num_trees_; ++t) {
+    leaf_offsets_.push_back(leaf_values_.size());
+    weights_.push_back(ensemble.getWeight(first_tree + t));
+    visit(ensemble.getTree(first_tree + t), t, leaf_offsets_.back(),
+          leaf_values_, nodes);
+  }
+
+  // group nodes by feature and sort them by threshold
+  std::sort(nodes.begin(), nodes.end());
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    if (i == 0 || nodes[i].feature != nodes[i - 1].feature) {
+      features_.push_back(nodes[i].feature);
+      feature_offsets_.push_back(i);
+    }
+    thresholds_.push_back(nodes[i].threshold);
+    tree_ids_.push_back(nodes[i].tree_id);
+    masks_.push_back(nodes[i].mask);
+  }
+  feature_offsets_.push_back(nodes.size());
+}
+
+Score QuickScorer::score_document(const Feature *d) const {
+  static thread_local std::vector<BitVector> leafidx;
+  leafidx.assign(num_trees_, ~(BitVector) 0);
+
+  for (size_t f = 0; f < features_.size(); ++f) {
+    const Feature x = d[features_[f]];
+    // the test of a node is false unless x <= threshold, NaN included
+    size_t i = feature_offsets_[f];
+    const size_t end = feature_offsets_[f + 1];
+    while (i < end && !(x <= thresholds_[i])) {
+      leafidx[tree_ids_[i]] &= masks_[i];
+      ++i;
+    }
+  }
+
+  // the sum follows the order of the trees, as in Ensemble::score_instance
+  double score = 0.0;
+  for (size_t t = 0; t < num_trees_; ++t) {
+    const size_t leaf = __builtin_ctzll(leafidx[t]);
+    score += leaf_values_[leaf_offsets_[t] + leaf] * weights_[t];
+  }
+  return score;
+}
+
+}  // namespace scoring
+}  // namespace quickrank
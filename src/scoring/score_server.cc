@@ -0,0 +1,312 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "scoring/score_server.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+namespace quickrank {
+namespace scoring {
+
+namespace {
+
+/// Reads exactly \a size bytes, returns the number of bytes read, which is
+/// less than \a size only at end of file or on errors.
+size_t read_fully(int fd, void *data, size_t size) {
+  size_t done = 0;
+  while (done < size) {
+    ssize_t n = read(fd, (char *) data + done, size - done);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      break;
+    done += n;
+  }
+  return done;
+}
+
+/// Writes exactly \a size bytes, returns false on errors.
+bool write_fully(int fd, const void *data, size_t size) {
+  size_t done = 0;
+  while (done < size) {
+    ssize_t n = write(fd, (const char *) data + done, size - done);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      return false;
+    done += n;
+  }
+  return true;
+}
+
+/// The listening socket closed by the signal handler to stop the server.
+volatile sig_atomic_t listening_fd = -1;
+
+extern "C" void stop_listening(int) {
+  if (listening_fd >= 0)
+    shutdown(listening_fd, SHUT_RDWR);
+}
+
+}  // namespace
+
+const uint32_t ScoreServer::STATUS_OK;
+const uint32_t ScoreServer::STATUS_BAD_REQUEST;
+const size_t ScoreServer::MAX_DOCUMENTS;
+const size_t ScoreServer::MAX_FEATURES;
+
+ScoreServer::ScoreServer(std::shared_ptr<ScoringEngine> engine,
+                         size_t num_features)
+    : model_(std::make_shared<ModelHandle>(engine)),
+      num_features_(num_features) {
+}
+
+ScoreServer::ScoreServer(std::shared_ptr<ModelHandle> model,
+                         size_t num_features)
+    : model_(model), num_features_(num_features) {
+}
+
+bool ScoreServer::serve_stream(int in_fd, int out_fd) {
+  std::vector<Feature> features;
+  std::vector<Feature> padded;
+  std::vector<Score> scores;
+  std::vector<uint32_t> indices;
+
+  for (;;) {
+    uint32_t header[3];
+    size_t header_size = read_fully(in_fd, header, sizeof(header));
+    if (header_size == 0)
+      return true;
+    if (header_size < sizeof(header))
+      return false;
+
+    const size_t num_documents = header[0];
+    const size_t num_features = header[1];
+    const size_t top_k = header[2];
+    if (num_documents > MAX_DOCUMENTS || num_features > MAX_FEATURES
+        || num_features > num_features_) {
+      uint32_t response[2] = {STATUS_BAD_REQUEST, 0};
+      write_fully(out_fd, response, sizeof(response));
+      return false;
+    }
+
+    features.resize(num_documents * num_features);
+    if (read_fully(in_fd, features.data(), features.size() * sizeof(Feature))
+        < features.size() * sizeof(Feature))
+      return false;
+
+    auto start = std::chrono::steady_clock::now();
+
+    // missing features are zeros, as in SVML files
+    const Feature *documents = features.data();
+    if (num_features < num_features_) {
+      padded.assign(num_documents * num_features_, 0.0f);
+      for (size_t i = 0; i < num_documents; ++i)
+        std::copy(features.begin() + i * num_features,
+                  features.begin() + (i + 1) * num_features,
+                  padded.begin() + i * num_features_);
+      documents = padded.data();
+    }
+
+    scores.resize(num_documents);
+    std::shared_ptr<ScoringEngine> engine = model_->get();
+    if (num_documents > 0)
+      engine->score_documents(documents, num_documents, num_features_,
+                              scores.data());
+    engine.reset();
+
+    bool written;
+    if (top_k == 0) {
+      uint32_t response[2] = {STATUS_OK, (uint32_t) num_documents};
+      written = write_fully(out_fd, response, sizeof(response))
+          && write_fully(out_fd, scores.data(), scores.size() * sizeof(Score));
+    } else {
+      // ties are broken by index, so that rankings are deterministic
+      const size_t k = std::min(top_k, num_documents);
+      indices.resize(num_documents);
+      for (size_t i = 0; i < num_documents; ++i)
+        indices[i] = i;
+      std::partial_sort(indices.begin(), indices.begin() + k, indices.end(),
+                        [&scores](uint32_t a, uint32_t b) {
+                          return scores[a] > scores[b]
+                              || (scores[a] == scores[b] && a < b);
+                        });
+      uint32_t response[2] = {STATUS_OK, (uint32_t) k};
+      written = write_fully(out_fd, response, sizeof(response))
+          && write_fully(out_fd, indices.data(), k * sizeof(uint32_t));
+    }
+    if (!written)
+      return false;
+
+    double latency = std::chrono::duration_cast<std::chrono::duration<double>>(
+        std::chrono::steady_clock::now() - start).count();
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    num_documents_ += num_documents;
+    latencies_.push_back(latency);
+  }
+}
+
+void ScoreServer::serve_socket(const std::string &path, size_t num_threads) {
+  struct sockaddr_un address;
+  if (path.size() >= sizeof(address.sun_path)) {
+    std::cerr << "!!! Socket path is too long: " << path << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  strcpy(address.sun_path, path.c_str());
+
+  // remove the socket left by a previous server
+  struct stat st;
+  if (stat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode))
+    unlink(path.c_str());
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0 || bind(fd, (struct sockaddr *) &address, sizeof(address)) != 0
+      || listen(fd, SOMAXCONN) != 0) {
+    std::cerr << "!!! Error while listening on " << path << ": "
+              << strerror(errno) << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  // signals stop accepting connections, broken connections are just closed
+  struct sigaction stop, old_int, old_term, old_pipe;
+  memset(&stop, 0, sizeof(stop));
+  stop.sa_handler = stop_listening;
+  sigemptyset(&stop.sa_mask);
+  listening_fd = fd;
+  sigaction(SIGINT, &stop, &old_int);
+  sigaction(SIGTERM, &stop, &old_term);
+  struct sigaction ignore = stop;
+  ignore.sa_handler = SIG_IGN;
+  sigaction(SIGPIPE, &ignore, &old_pipe);
+
+  std::vector<std::thread> workers;
+  for (size_t t = 0; t < std::max(num_threads, (size_t) 1); ++t)
+    workers.push_back(std::thread([this, fd]() {
+      for (;;) {
+        int connection = accept(fd, NULL, NULL);
+        if (connection < 0 && errno == EINTR)
+          continue;
+        if (connection < 0)
+          break;
+        serve_stream(connection, connection);
+        close(connection);
+      }
+    }));
+  for (auto &worker: workers)
+    worker.join();
+
+  listening_fd = -1;
+  sigaction(SIGINT, &old_int, NULL);
+  sigaction(SIGTERM, &old_term, NULL);
+  sigaction(SIGPIPE, &old_pipe, NULL);
+  close(fd);
+  unlink(path.c_str());
+}
+
+size_t ScoreServer::num_requests() const {
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  return latencies_.size();
+}
+
+size_t ScoreServer::num_documents() const {
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  return num_documents_;
+}
+
+std::vector<double> ScoreServer::latencies() const {
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  return latencies_;
+}
+
+ScoreClient::ScoreClient(const std::string &path)
+    : in_fd_(-1), out_fd_(-1) {
+  struct sockaddr_un address;
+  if (path.size() >= sizeof(address.sun_path))
+    return;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  strcpy(address.sun_path, path.c_str());
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0)
+    return;
+  if (connect(fd, (struct sockaddr *) &address, sizeof(address)) != 0) {
+    close(fd);
+    return;
+  }
+  in_fd_ = out_fd_ = fd;
+}
+
+ScoreClient::ScoreClient(int in_fd, int out_fd)
+    : in_fd_(in_fd), out_fd_(out_fd) {
+}
+
+ScoreClient::~ScoreClient() {
+  if (out_fd_ >= 0 && out_fd_ != in_fd_)
+    close(out_fd_);
+  if (in_fd_ >= 0)
+    close(in_fd_);
+}
+
+uint32_t ScoreClient::score(const Feature *d, size_t num_documents,
+                            size_t num_features, size_t top_k,
+                            std::vector<Score> &scores,
+                            std::vector<uint32_t> &top) {
+  uint32_t request[3] = {(uint32_t) num_documents, (uint32_t) num_features,
+                         (uint32_t) top_k};
+  if (!write_fully(out_fd_, request, sizeof(request))
+      || !write_fully(out_fd_, d,
+                      num_documents * num_features * sizeof(Feature)))
+    return ScoreServer::STATUS_BAD_REQUEST;
+
+  uint32_t response[2];
+  if (read_fully(in_fd_, response, sizeof(response)) < sizeof(response))
+    return ScoreServer::STATUS_BAD_REQUEST;
+  if (response[0] != ScoreServer::STATUS_OK)
+    return response[0];
+
+  bool complete;
+  if (top_k == 0) {
+    scores.resize(response[1]);
+    complete = read_fully(in_fd_, scores.data(), scores.size() * sizeof(Score))
+        == scores.size() * sizeof(Score);
+  } else {
+    top.resize(response[1]);
+    complete = read_fully(in_fd_, top.data(), top.size() * sizeof(uint32_t))
+        == top.size() * sizeof(uint32_t);
+  }
+  return complete ? ScoreServer::STATUS_OK : ScoreServer::STATUS_BAD_REQUEST;
+}
+
+}  // namespace scoring
+}  // namespace quickrank
@@ -0,0 +1,52 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include <algorithm>
+
+#include "scoring/scoring_engine.h"
+#include "utils/perf_counters.h"
+
+namespace quickrank {
+namespace scoring {
+
+const size_t ScoringEngine::DOCUMENTS_BLOCK_SIZE;
+
+void ScoringEngine::score_documents(const Feature *d, size_t num_documents,
+                                    size_t stride, Score *scores) const {
+  for (size_t i = 0; i < num_documents; i++)
+    scores[i] = score_document(d + i * stride);
+}
+
+void ScoringEngine::score_dataset(std::shared_ptr<data::Dataset> dataset,
+                                  Score *scores) const {
+  QUICKRANK_PERF_PHASE("scoring");
+  const Feature *d = dataset->at(0, 0);
+  const size_t num_documents = dataset->num_instances();
+  const size_t stride = dataset->num_features();
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t i = 0; i < num_documents; i += DOCUMENTS_BLOCK_SIZE)
+    score_documents(d + i * stride,
+                    std::min(DOCUMENTS_BLOCK_SIZE, num_documents - i),
+                    stride, scores + i);
+}
+
+}  // namespace scoring
+}  // namespace quickrank
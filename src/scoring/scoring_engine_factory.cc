@@ -0,0 +1,102 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include <algorithm>
+
+#include "scoring/scoring_engine_factory.h"
+#include "scoring/default_engine.h"
+#include "scoring/quickscorer.h"
+#include "scoring/vquickscorer.h"
+#include "scoring/blockwise_quickscorer.h"
+#include "scoring/vpred.h"
+#include "scoring/oblivious_engine.h"
+#include "scoring/compiled_scorer.h"
+#include "learning/forests/mart.h"
+#include "learning/forests/obliviousmart.h"
+#include "learning/forests/obliviouslambdamart.h"
+
+namespace quickrank {
+namespace scoring {
+
+const std::vector<std::string> scoringEngineNames = {
+    DefaultEngine::NAME_, QuickScorer::NAME_, VQuickScorer::NAME_,
+    BlockWiseQuickScorer::NAME_, VPred::NAME_, ObliviousEngine::NAME_,
+    CompiledScorer::PREFIX_ + "CONDOP", CompiledScorer::PREFIX_ + "OBLIVIOUS"
+};
+
+std::shared_ptr<ScoringEngine> scoring_engine_factory(
+    std::string engine, std::shared_ptr<learning::LTR_Algorithm> ranker,
+    size_t trees_block_size, size_t documents_block_size) {
+  std::transform(engine.begin(), engine.end(), engine.begin(), ::toupper);
+
+  if (!ranker)
+    return std::shared_ptr<ScoringEngine>();
+
+  if (engine == DefaultEngine::NAME_)
+    return std::shared_ptr<ScoringEngine>(new DefaultEngine(ranker));
+
+  // the following engines work on tree ensembles only
+  auto forest = std::dynamic_pointer_cast<learning::forests::Mart>(ranker);
+  if (!forest)
+    return std::shared_ptr<ScoringEngine>();
+
+  // the QuickScorer family is limited to small trees
+  if ((engine == QuickScorer::NAME_ || engine == VQuickScorer::NAME_
+      || engine == BlockWiseQuickScorer::NAME_)
+      && !QuickScorer::supports(forest->ensemble()))
+    return std::shared_ptr<ScoringEngine>();
+
+  if (engine == QuickScorer::NAME_)
+    return std::shared_ptr<ScoringEngine>(new QuickScorer(forest->ensemble()));
+  else if (engine == VQuickScorer::NAME_)
+    return std::shared_ptr<ScoringEngine>(
+        new VQuickScorer(forest->ensemble()));
+  else if (engine == BlockWiseQuickScorer::NAME_)
+    return std::shared_ptr<ScoringEngine>(
+        new BlockWiseQuickScorer(forest->ensemble(), trees_block_size,
+                                 documents_block_size));
+  else if (engine == VPred::NAME_) {
+    // complete trees are limited in depth
+    if (VPred::supports(forest->ensemble()))
+      return std::shared_ptr<ScoringEngine>(new VPred(forest->ensemble()));
+  } else if (engine == ObliviousEngine::NAME_) {
+    // the engine is built for oblivious models only
+    if ((std::dynamic_pointer_cast<learning::forests::ObliviousMart>(ranker)
+        || std::dynamic_pointer_cast<learning::forests::ObliviousLambdaMart>(
+            ranker))
+        && ObliviousEngine::supports(forest->ensemble()))
+      return std::shared_ptr<ScoringEngine>(
+          new ObliviousEngine(forest->ensemble()));
+  } else if (engine == CompiledScorer::PREFIX_ + "CONDOP")
+    return CompiledScorer::create(*forest, "CONDOP");
+  else if (engine == CompiledScorer::PREFIX_ + "OBLIVIOUS") {
+    // the generated code relies on the depth of oblivious models
+    if (std::dynamic_pointer_cast<learning::forests::ObliviousMart>(ranker)
+        || std::dynamic_pointer_cast<learning::forests::ObliviousLambdaMart>(
+            ranker))
+      return CompiledScorer::create(*forest, "OBLIVIOUS");
+  }
+
+  return std::shared_ptr<ScoringEngine>();
+}
+
+}  // namespace scoring
+}  // namespace quickrank
@@ -0,0 +1,144 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include <algorithm>
+
+#include "scoring/vpred.h"
+
+namespace quickrank {
+namespace scoring {
+
+const std::string VPred::NAME_ = "VPRED";
+
+namespace {
+
+size_t tree_depth(const RTNode *node) {
+  if (node->is_leaf())
+    return 0;
+  return 1 + std::max(tree_depth(node->left), tree_depth(node->right));
+}
+
+}  // namespace
+
+bool VPred::supports(const Ensemble &ensemble) {
+  for (size_t t = 0; t < ensemble.get_size(); ++t)
+    if (tree_depth(ensemble.getTree(t)) > MAX_DEPTH)
+      return false;
+  return true;
+}
+
+VPred::VPred(const Ensemble &ensemble) {
+  size_t num_nodes = 0;
+  size_t num_leaves = 0;
+  for (size_t t = 0; t < ensemble.get_size(); ++t) {
+    complete_tree tree;
+    tree.depth = tree_depth(ensemble.getTree(t));
+    if (tree.depth > MAX_DEPTH) {
+      std::cerr << "!!! " << NAME_ << " supports trees with depth at most "
+                << MAX_DEPTH << "." << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    tree.first_node = num_nodes;
+    tree.first_leaf = num_leaves;
+    num_nodes += ((size_t) 1 << tree.depth) - 1;
+    num_leaves += (size_t) 1 << tree.depth;
+    trees_.push_back(tree);
+    weights_.push_back(ensemble.getWeight(t));
+  }
+
+  features_.resize(num_nodes, 0);
+  thresholds_.resize(num_nodes, 0.0f);
+  leaves_.resize(num_leaves, 0.0);
+  for (size_t t = 0; t < trees_.size(); ++t)
+    fill(trees_[t], ensemble.getTree(t), 0, 0);
+}
+
+void VPred::fill(const complete_tree &tree, const RTNode *node, size_t pos,
+                 size_t level) {
+  if (level == tree.depth) {
+    leaves_[tree.first_leaf + pos - (((size_t) 1 << tree.depth) - 1)] =
+        node->avglabel;
+    return;
+  }
+  if (node->is_leaf()) {
+    // a shallow leaf is copied to all the leaves below it, whatever the
+    // outcome of the (dummy) tests on the way
+    fill(tree, node, 2 * pos + 1, level + 1);
+    fill(tree, node, 2 * pos + 2, level + 1);
+    return;
+  }
+  features_[tree.first_node + pos] = node->get_feature_idx();
+  thresholds_[tree.first_node + pos] = node->threshold;
+  fill(tree, node->left, 2 * pos + 1, level + 1);
+  fill(tree, node->right, 2 * pos + 2, level + 1);
+}
+
+Score VPred::score_document(const Feature *d) const {
+  double score = 0.0;
+  for (size_t t = 0; t < trees_.size(); ++t) {
+    const uint32_t *features = features_.data() + trees_[t].first_node;
+    const Feature *thresholds = thresholds_.data() + trees_[t].first_node;
+    size_t pos = 0;
+    for (size_t level = 0; level < trees_[t].depth; ++level)
+      pos = 2 * pos + 1 + !(d[features[pos]] <= thresholds[pos]);
+    const size_t num_nodes = ((size_t) 1 << trees_[t].depth) - 1;
+    score += leaves_[trees_[t].first_leaf + pos - num_nodes] * weights_[t];
+  }
+  return score;
+}
+
+void VPred::score_documents(const Feature *d, size_t num_documents,
+                            size_t stride, Score *scores) const {
+  for (size_t i = 0; i < num_documents; i += DOCUMENTS_AT_ONCE)
+    score_block(d + i * stride,
+                std::min(DOCUMENTS_AT_ONCE, num_documents - i), stride,
+                scores + i);
+}
+
+void VPred::score_block(const Feature *d, size_t num_documents, size_t stride,
+                        Score *scores) const {
+  // missing documents are replaced by the first one
+  const Feature *docs[DOCUMENTS_AT_ONCE];
+  for (size_t j = 0; j < DOCUMENTS_AT_ONCE; ++j)
+    docs[j] = d + (j < num_documents ? j : 0) * stride;
+
+  double sums[DOCUMENTS_AT_ONCE] = {0.0};
+  for (size_t t = 0; t < trees_.size(); ++t) {
+    const uint32_t *features = features_.data() + trees_[t].first_node;
+    const Feature *thresholds = thresholds_.data() + trees_[t].first_node;
+
+    // the false test, NaN included, leads to the right child
+    size_t pos[DOCUMENTS_AT_ONCE] = {0};
+    for (size_t level = 0; level < trees_[t].depth; ++level)
+      for (size_t j = 0; j < DOCUMENTS_AT_ONCE; ++j)
+        pos[j] = 2 * pos[j] + 1
+            + !(docs[j][features[pos[j]]] <= thresholds[pos[j]]);
+
+    const double *leaves = leaves_.data() + trees_[t].first_leaf;
+    const size_t num_nodes = ((size_t) 1 << trees_[t].depth) - 1;
+    for (size_t j = 0; j < DOCUMENTS_AT_ONCE; ++j)
+      sums[j] += leaves[pos[j] - num_nodes] * weights_[t];
+  }
+  std::copy(sums, sums + num_documents, scores);
+}
+
+}  // namespace scoring
+}  // namespace quickrank
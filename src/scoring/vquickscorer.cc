@@ -0,0 +1,230 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include <algorithm>
+
+#include "scoring/vquickscorer.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define QUICKRANK_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace quickrank {
+namespace scoring {
+
+const std::string VQuickScorer::NAME_ = "VQUICKSCORER";
+
+const std::vector<std::string> VQuickScorer::instructionSetNames = {
+    "SCALAR", "AVX2", "AVX512"
+};
+
+namespace {
+
+/// Number of documents scored at once by each instruction set.
+const size_t SCALAR_WIDTH = 8;
+const size_t AVX2_WIDTH = 8;
+const size_t AVX512_WIDTH = 16;
+
+/// Copies the value of \a feature of up to \a width documents in \a x.
+/// Missing documents are replaced by the first one.
+inline void gather_feature(const Feature *d, size_t num_documents,
+                           size_t stride, size_t feature, size_t width,
+                           Feature *x) {
+  for (size_t j = 0; j < width; ++j)
+    x[j] = d[(j < num_documents ? j : 0) * stride + feature];
+}
+
+}  // namespace
+
+VQuickScorer::VQuickScorer(const Ensemble &ensemble,
+                           InstructionSet instruction_set,
+                           size_t first_tree, size_t last_tree)
+    : QuickScorer(ensemble, first_tree, last_tree) {
+  instruction_set_ = std::min(instruction_set, supported_instruction_set());
+}
+
+VQuickScorer::InstructionSet VQuickScorer::supported_instruction_set() {
+#ifdef QUICKRANK_X86_SIMD
+  if (__builtin_cpu_supports("avx512f"))
+    return InstructionSet::AVX512;
+  if (__builtin_cpu_supports("avx2"))
+    return InstructionSet::AVX2;
+#endif
+  return InstructionSet::SCALAR;
+}
+
+void VQuickScorer::score_documents(const Feature *d, size_t num_documents,
+                                   size_t stride, Score *scores) const {
+  std::fill(scores, scores + num_documents, 0.0);
+  accumulate_documents(d, num_documents, stride, scores);
+}
+
+void VQuickScorer::accumulate_documents(const Feature *d,
+                                        size_t num_documents, size_t stride,
+                                        Score *scores) const {
+  static thread_local std::vector<BitVector> leafidx;
+  leafidx.resize(num_trees_ * AVX512_WIDTH);
+
+  size_t width = SCALAR_WIDTH;
+  if (instruction_set_ == InstructionSet::AVX2)
+    width = AVX2_WIDTH;
+  else if (instruction_set_ == InstructionSet::AVX512)
+    width = AVX512_WIDTH;
+
+  for (size_t i = 0; i < num_documents; i += width) {
+    const size_t block_size = std::min(width, num_documents - i);
+    std::fill(leafidx.begin(), leafidx.begin() + num_trees_ * width,
+              ~(BitVector) 0);
+    switch (instruction_set_) {
+#ifdef QUICKRANK_X86_SIMD
+      case InstructionSet::AVX512:
+        score_block_avx512(d + i * stride, block_size, stride, scores + i,
+                           leafidx.data());
+        break;
+      case InstructionSet::AVX2:
+        score_block_avx2(d + i * stride, block_size, stride, scores + i,
+                         leafidx.data());
+        break;
+#endif
+      default:
+        score_block_scalar(d + i * stride, block_size, stride, scores + i,
+                           leafidx.data());
+    }
+  }
+}
+
+void VQuickScorer::score_block_scalar(const Feature *d, size_t num_documents,
+                                      size_t stride, Score *scores,
+                                      BitVector *leafidx) const {
+  Feature x[SCALAR_WIDTH];
+  for (size_t f = 0; f < features_.size(); ++f) {
+    gather_feature(d, num_documents, stride, features_[f], SCALAR_WIDTH, x);
+    for (size_t i = feature_offsets_[f]; i < feature_offsets_[f + 1]; ++i) {
+      // stop when the test is true for all the documents
+      bool any_false = false;
+      BitVector *tree_leafidx = leafidx + tree_ids_[i] * SCALAR_WIDTH;
+      for (size_t j = 0; j < SCALAR_WIDTH; ++j)
+        if (!(x[j] <= thresholds_[i])) {
+          tree_leafidx[j] &= masks_[i];
+          any_false = true;
+        }
+      if (!any_false)
+        break;
+    }
+  }
+  sum_leaves(leafidx, SCALAR_WIDTH, num_documents, scores);
+}
+
+#ifdef QUICKRANK_X86_SIMD
+
+__attribute__((target("avx2")))
+void VQuickScorer::score_block_avx2(const Feature *d, size_t num_documents,
+                                    size_t stride, Score *scores,
+                                    BitVector *leafidx) const {
+  Feature x[AVX2_WIDTH];
+  for (size_t f = 0; f < features_.size(); ++f) {
+    gather_feature(d, num_documents, stride, features_[f], AVX2_WIDTH, x);
+    const __m256 values = _mm256_loadu_ps(x);
+    for (size_t i = feature_offsets_[f]; i < feature_offsets_[f + 1]; ++i) {
+      // false tests, NaN included
+      const __m256 false_tests = _mm256_cmp_ps(
+          values, _mm256_set1_ps(thresholds_[i]), _CMP_NLE_UQ);
+      if (!_mm256_movemask_ps(false_tests))
+        break;
+      // widen the 32-bit comparison masks to the 64-bit bitvectors
+      const __m256i tests = _mm256_castps_si256(false_tests);
+      const __m256i tests_lo =
+          _mm256_cvtepi32_epi64(_mm256_castsi256_si128(tests));
+      const __m256i tests_hi =
+          _mm256_cvtepi32_epi64(_mm256_extracti128_si256(tests, 1));
+      const __m256i mask = _mm256_set1_epi64x(masks_[i]);
+      __m256i *tree_leafidx =
+          (__m256i *) (leafidx + tree_ids_[i] * AVX2_WIDTH);
+      // leafidx &= ~(~mask & tests)
+      _mm256_storeu_si256(tree_leafidx, _mm256_andnot_si256(
+          _mm256_andnot_si256(mask, tests_lo),
+          _mm256_loadu_si256(tree_leafidx)));
+      _mm256_storeu_si256(tree_leafidx + 1, _mm256_andnot_si256(
+          _mm256_andnot_si256(mask, tests_hi),
+          _mm256_loadu_si256(tree_leafidx + 1)));
+    }
+  }
+  sum_leaves(leafidx, AVX2_WIDTH, num_documents, scores);
+}
+
+__attribute__((target("avx512f")))
+void VQuickScorer::score_block_avx512(const Feature *d, size_t num_documents,
+                                      size_t stride, Score *scores,
+                                      BitVector *leafidx) const {
+  Feature x[AVX512_WIDTH];
+  for (size_t f = 0; f < features_.size(); ++f) {
+    gather_feature(d, num_documents, stride, features_[f], AVX512_WIDTH, x);
+    const __m512 values = _mm512_loadu_ps(x);
+    for (size_t i = feature_offsets_[f]; i < feature_offsets_[f + 1]; ++i) {
+      // false tests, NaN included
+      const __mmask16 false_tests = _mm512_cmp_ps_mask(
+          values, _mm512_set1_ps(thresholds_[i]), _CMP_NLE_UQ);
+      if (!false_tests)
+        break;
+      const __m512i mask = _mm512_set1_epi64(masks_[i]);
+      BitVector *tree_leafidx = leafidx + tree_ids_[i] * AVX512_WIDTH;
+      __m512i lo = _mm512_loadu_si512(tree_leafidx);
+      __m512i hi = _mm512_loadu_si512(tree_leafidx + 8);
+      lo = _mm512_mask_and_epi64(lo, (__mmask8) false_tests, lo, mask);
+      hi = _mm512_mask_and_epi64(hi, (__mmask8) (false_tests >> 8), hi, mask);
+      _mm512_storeu_si512(tree_leafidx, lo);
+      _mm512_storeu_si512(tree_leafidx + 8, hi);
+    }
+  }
+  sum_leaves(leafidx, AVX512_WIDTH, num_documents, scores);
+}
+
+#else
+
+void VQuickScorer::score_block_avx2(const Feature *d, size_t num_documents,
+                                    size_t stride, Score *scores,
+                                    BitVector *leafidx) const {
+  score_block_scalar(d, num_documents, stride, scores, leafidx);
+}
+
+void VQuickScorer::score_block_avx512(const Feature *d, size_t num_documents,
+                                      size_t stride, Score *scores,
+                                      BitVector *leafidx) const {
+  score_block_scalar(d, num_documents, stride, scores, leafidx);
+}
+
+#endif
+
+void VQuickScorer::sum_leaves(const BitVector *leafidx, size_t width,
+                              size_t num_documents, Score *scores) const {
+  double sums[AVX512_WIDTH];
+  std::copy(scores, scores + num_documents, sums);
+  for (size_t t = 0; t < num_trees_; ++t) {
+    const double *leaves = leaf_values_.data() + leaf_offsets_[t];
+    for (size_t j = 0; j < num_documents; ++j)
+      sums[j] += leaves[__builtin_ctzll(leafidx[t * width + j])] * weights_[t];
+  }
+  std::copy(sums, sums + num_documents, scores);
+}
+
+}  // namespace scoring
+}  // namespace quickrank
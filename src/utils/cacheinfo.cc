@@ -0,0 +1,71 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include <unistd.h>
+#include <fstream>
+#include <string>
+
+#include "utils/cacheinfo.h"
+
+namespace {
+
+/// Reads the cache description exported by Linux in sysfs.
+size_t sysfs_cache_size(unsigned int level) {
+  for (unsigned int index = 0; index < 8; ++index) {
+    std::string path = "/sys/devices/system/cpu/cpu0/cache/index"
+        + std::to_string(index) + "/";
+    std::ifstream level_file(path + "level");
+    std::ifstream type_file(path + "type");
+    std::ifstream size_file(path + "size");
+    unsigned int cache_level;
+    std::string type, size;
+    if (!(level_file >> cache_level) || !(type_file >> type)
+        || !(size_file >> size))
+      break;
+    if (cache_level != level || type == "Instruction")
+      continue;
+    // sizes are given as, e.g., 32K or 8M
+    size_t bytes = strtoul(size.c_str(), NULL, 10);
+    if (size.back() == 'K')
+      bytes <<= 10;
+    else if (size.back() == 'M')
+      bytes <<= 20;
+    return bytes;
+  }
+  return 0;
+}
+
+}  // namespace
+
+size_t data_cache_size(unsigned int level) {
+  long bytes = 0;
+#if defined(_SC_LEVEL1_DCACHE_SIZE) && defined(_SC_LEVEL3_CACHE_SIZE)
+  if (level == 1)
+    bytes = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+  else if (level == 2)
+    bytes = sysconf(_SC_LEVEL2_CACHE_SIZE);
+  else if (level == 3)
+    bytes = sysconf(_SC_LEVEL3_CACHE_SIZE);
+#endif
+  if (bytes > 0)
+    return bytes;
+  return sysfs_cache_size(level);
+}
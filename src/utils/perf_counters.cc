@@ -0,0 +1,151 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include <cstring>
+#include <iomanip>
+#include <map>
+#include <mutex>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "utils/perf_counters.h"
+
+const std::vector<std::string> PerfCounters::eventNames = {
+    "cycles", "instructions", "branch-misses", "cache-misses"
+};
+
+PerfCounters::PerfCounters() {
+  for (size_t e = 0; e < NUM_EVENTS; ++e)
+    fds_[e] = -1;
+#ifdef __linux__
+  const uint64_t configs[NUM_EVENTS] = {
+      PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+      PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_HW_CACHE_MISSES
+  };
+  for (size_t e = 0; e < NUM_EVENTS; ++e) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = configs[e];
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    // the calling thread, on any cpu
+    fds_[e] = (int) syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+  }
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+  for (size_t e = 0; e < NUM_EVENTS; ++e)
+    if (fds_[e] >= 0)
+      close(fds_[e]);
+#endif
+}
+
+void PerfCounters::read(uint64_t values[NUM_EVENTS]) const {
+  for (size_t e = 0; e < NUM_EVENTS; ++e) {
+    values[e] = 0;
+#ifdef __linux__
+    if (fds_[e] >= 0 && ::read(fds_[e], &values[e], sizeof(uint64_t))
+        != sizeof(uint64_t))
+      values[e] = 0;
+#endif
+  }
+}
+
+namespace {
+
+struct PhaseStats {
+  size_t calls = 0;
+  uint64_t events[PerfCounters::NUM_EVENTS] = {0};
+};
+
+std::mutex phases_mutex;
+std::map<std::string, PhaseStats> phases;
+
+/// Counters are opened by each thread the first time they are needed.
+const PerfCounters &thread_counters() {
+  static thread_local PerfCounters counters;
+  return counters;
+}
+
+/// Sums the counters of all the threads of the team.
+void read_team(uint64_t values[PerfCounters::NUM_EVENTS]) {
+  for (size_t e = 0; e < PerfCounters::NUM_EVENTS; ++e)
+    values[e] = 0;
+#pragma omp parallel
+  {
+    uint64_t thread_values[PerfCounters::NUM_EVENTS];
+    thread_counters().read(thread_values);
+#pragma omp critical(quickrank_perf_counters)
+    for (size_t e = 0; e < PerfCounters::NUM_EVENTS; ++e)
+      values[e] += thread_values[e];
+  }
+}
+
+}  // namespace
+
+PerfPhase::PerfPhase(const std::string &name)
+    : name_(name) {
+  read_team(start_);
+}
+
+PerfPhase::~PerfPhase() {
+  uint64_t end[PerfCounters::NUM_EVENTS];
+  read_team(end);
+  std::lock_guard<std::mutex> lock(phases_mutex);
+  PhaseStats &stats = phases[name_];
+  stats.calls++;
+  for (size_t e = 0; e < PerfCounters::NUM_EVENTS; ++e)
+    stats.events[e] += end[e] - start_[e];
+}
+
+void PerfPhase::report(std::ostream &os) {
+  std::lock_guard<std::mutex> lock(phases_mutex);
+  const PerfCounters &counters = thread_counters();
+  os << "#" << std::endl;
+  os << "# Hardware performance counters (average per call):" << std::endl;
+  bool any = false;
+  for (size_t e = 0; e < PerfCounters::NUM_EVENTS; ++e)
+    any |= counters.available((PerfCounters::Event) e);
+  if (!any) {
+    os << "#   not available" << std::endl;
+    return;
+  }
+  for (auto &phase: phases) {
+    os << "#   " << phase.first << " (" << phase.second.calls << " calls):";
+    for (size_t e = 0; e < PerfCounters::NUM_EVENTS; ++e) {
+      os << " " << PerfCounters::eventNames[e] << " ";
+      if (counters.available((PerfCounters::Event) e))
+        os << std::setprecision(4)
+           << (double) phase.second.events[e] / phase.second.calls;
+      else
+        os << "n/a";
+    }
+    os << std::endl;
+  }
+}